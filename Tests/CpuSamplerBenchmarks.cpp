@@ -0,0 +1,55 @@
+/**
+ * @file CpuSamplerBenchmarks.cpp
+ * @brief Benchmarks of the CPU energy attribution.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "Test.h"
+
+#include "CpuSampler.h"
+#include "ScriptedPowerSource.h"
+
+/**
+ * @var {size_t} SAMPLES
+ * @brief The number of ticks of each measured loop
+ */
+static constexpr size_t SAMPLES = 200;
+
+/**
+ * @brief Samples applications of a few pids each, the process times are the real ones of the machine
+ * @function runSamples
+ * @param {size_t} appCount - The number of applications
+ * @param {size_t} pidsPerApp - The number of pids of each application
+ * @returns {std::chrono::steady_clock::duration} the time of the loop
+ */
+static std::chrono::steady_clock::duration runSamples(size_t appCount, size_t pidsPerApp)
+{
+	CpuSampler cpu{ std::make_unique<ScriptedPowerSource>(1.0) };
+	int pid = 4;
+	for (size_t app = 0; app < appCount; app++)
+	{
+		std::vector<int> pids;
+		for (size_t i = 0; i < pidsPerApp; i++, pid += 4)
+		{
+			pids.push_back(pid);
+		}
+		pids[0] = app == 0 ? ScriptedPowerSource::getOwnPid() : pids[0];
+		cpu.addApp({ static_cast<uint32_t>(app), 1 }, pids);
+	}
+
+	cpu.sample();
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < SAMPLES; i++)
+	{
+		cpu.sample();
+	}
+	return std::chrono::steady_clock::now() - start;
+}
+
+BENCHMARK("CPU sampler tick")
+{
+	Test::report("1 application of 1 pid", SAMPLES, runSamples(1, 1));
+	Test::report("10 applications of 10 pids", SAMPLES, runSamples(10, 10));
+	Test::report("100 applications of 10 pids", SAMPLES, runSamples(100, 10));
+}
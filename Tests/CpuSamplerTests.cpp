@@ -0,0 +1,94 @@
+/**
+ * @file CpuSamplerTests.cpp
+ * @brief Tests of the CPU energy attribution with a scripted power source.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "Test.h"
+
+#include "CpuSampler.h"
+#include "ScriptedPowerSource.h"
+
+TEST_CASE("CPU energy of an interval goes to the pids that used the CPU")
+{
+	ScriptedPowerSource* source = new ScriptedPowerSource(50.0);
+	CpuSampler cpu{ std::unique_ptr<PowerSource>(source) };
+	AppId busy = { 0, 1 };
+	AppId idle = { 1, 1 };
+	cpu.addApp(busy, { ScriptedPowerSource::getOwnPid() });
+	cpu.addApp(idle, { ScriptedPowerSource::UNUSED_PID });
+
+	CHECK(!cpu.sample());
+	ScriptedPowerSource::burnCpu(std::chrono::milliseconds(200));
+	REQUIRE(cpu.sample());
+
+	CHECK(cpu.getAppCount() == 2);
+	CHECK(cpu.getAppId(0) == busy);
+	CHECK(cpu.getAppEnergy(0) > 0.0);
+	CHECK(cpu.getAppEnergy(0) <= 50.0);
+	CHECK(cpu.getAppEnergy(1) == 0.0);
+}
+
+TEST_CASE("CPU energy of an application is the sum of its pids")
+{
+	CpuSampler cpu{ std::make_unique<ScriptedPowerSource>(50.0) };
+	int ownPid = ScriptedPowerSource::getOwnPid();
+	cpu.addApp({ 0, 1 }, { ownPid });
+	cpu.addApp({ 1, 1 }, { ScriptedPowerSource::UNUSED_PID, ownPid });
+
+	cpu.sample();
+	ScriptedPowerSource::burnCpu(std::chrono::milliseconds(100));
+	REQUIRE(cpu.sample());
+
+	CHECK(cpu.getAppEnergy(0) > 0.0);
+	CHECK_NEAR(cpu.getAppEnergy(1), cpu.getAppEnergy(0), 1e-12);
+}
+
+TEST_CASE("CPU sampler primes again after a failed read")
+{
+	ScriptedPowerSource* source = new ScriptedPowerSource(50.0);
+	CpuSampler cpu{ std::unique_ptr<PowerSource>(source) };
+	cpu.addApp({ 0, 1 }, { ScriptedPowerSource::getOwnPid() });
+
+	CHECK(!cpu.sample());
+	source->setFailing(true);
+	CHECK(!cpu.sample());
+	source->setFailing(false);
+
+	// The energy read before the failure is not the start of the next interval
+	CHECK(!cpu.sample());
+	ScriptedPowerSource::burnCpu(std::chrono::milliseconds(100));
+	REQUIRE(cpu.sample());
+	CHECK(cpu.getAppEnergy(0) <= 50.0);
+}
+
+TEST_CASE("CPU sampler without application measures nothing")
+{
+	CpuSampler cpu{ std::make_unique<ScriptedPowerSource>(50.0) };
+	CHECK(!cpu.sample());
+
+	cpu.addApp({ 0, 1 }, { ScriptedPowerSource::getOwnPid() });
+	CHECK(!cpu.sample());
+	cpu.clearApps();
+	CHECK(!cpu.sample());
+	CHECK(cpu.getAppCount() == 0);
+}
+
+TEST_CASE("CPU energy of each pid is kept next to the application")
+{
+	CpuSampler cpu{ std::make_unique<ScriptedPowerSource>(50.0) };
+	int ownPid = ScriptedPowerSource::getOwnPid();
+	cpu.addApp({ 0, 1 }, { ScriptedPowerSource::UNUSED_PID });
+	cpu.addApp({ 1, 1 }, { ScriptedPowerSource::UNUSED_PID, ownPid });
+
+	cpu.sample();
+	ScriptedPowerSource::burnCpu(std::chrono::milliseconds(100));
+	REQUIRE(cpu.sample());
+
+	const double* pidEnergies = cpu.getPidEnergies(1);
+	CHECK(cpu.getPidEnergies(0)[0] == 0.0);
+	CHECK(pidEnergies[0] == 0.0);
+	CHECK(pidEnergies[1] > 0.0);
+	CHECK_NEAR(pidEnergies[0] + pidEnergies[1], cpu.getAppEnergy(1), 1e-12);
+}
@@ -0,0 +1,143 @@
+/**
+ * @file DiskIoEventStream.cpp
+ * @brief Definition of the synthetic disk event stream used by the tests.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "DiskIoEventStream.h"
+
+#include <algorithm>
+
+DiskIoEventStream::DiskIoEventStream(uint32_t seed) : random(seed)
+{
+}
+
+void DiskIoEventStream::advance(uint64_t duration)
+{
+	now += duration;
+}
+
+void DiskIoEventStream::startProcess(uint32_t pid)
+{
+	events.push_back({ DiskIoTracer::EventType::ProcessStart, 0, pid, 0, now });
+}
+
+void DiskIoEventStream::endProcess(uint32_t pid)
+{
+	events.push_back({ DiskIoTracer::EventType::ProcessEnd, 0, pid, 0, now });
+}
+
+uint64_t DiskIoEventStream::issue(uint32_t pid, bool write, uint32_t size)
+{
+	uint64_t irp;
+	if (freeAddresses.empty())
+	{
+		irp = nextAddress;
+		nextAddress += 0x100;
+	}
+	else
+	{
+		irp = freeAddresses.back();
+		freeAddresses.pop_back();
+	}
+
+	inFlight[irp] = { pid, write, size };
+	events.push_back({ write ? DiskIoTracer::EventType::WriteInit : DiskIoTracer::EventType::ReadInit, irp, pid, 0, now });
+	return irp;
+}
+
+void DiskIoEventStream::complete(uint64_t irp)
+{
+	auto it = inFlight.find(irp);
+	if (it == inFlight.end())
+	{
+		return;
+	}
+
+	// The completion is logged in an arbitrary context, only the address links it to its process
+	const Request& request = it->second;
+	events.push_back({ request.write ? DiskIoTracer::EventType::WriteComplete : DiskIoTracer::EventType::ReadComplete, irp, 0, request.size, now });
+	(request.write ? writeBytes : readBytes)[request.pid] += request.size;
+
+	inFlight.erase(it);
+	freeAddresses.push_back(irp);
+}
+
+void DiskIoEventStream::lose(uint64_t irp)
+{
+	if (inFlight.erase(irp) > 0)
+	{
+		freeAddresses.push_back(irp);
+	}
+}
+
+void DiskIoEventStream::completeAll()
+{
+	std::vector<uint64_t> irps;
+	for (const auto& request : inFlight)
+	{
+		irps.push_back(request.first);
+	}
+
+	// The map order depends on the library, sort before shuffling so the order only depends on the seed
+	std::sort(irps.begin(), irps.end());
+	std::shuffle(irps.begin(), irps.end(), random);
+	for (uint64_t irp : irps)
+	{
+		complete(irp);
+	}
+}
+
+void DiskIoEventStream::addWorkload(const std::vector<uint32_t>& pids, size_t requestCount, uint64_t interval)
+{
+	std::uniform_int_distribution<size_t> pickProcess(0, pids.size() - 1);
+	std::uniform_int_distribution<uint32_t> pickPages(1, 64);
+	std::bernoulli_distribution pickWrite(0.4);
+
+	std::vector<uint64_t> pending;
+	for (size_t i = 0; i < requestCount; i++)
+	{
+		pending.push_back(issue(pids[pickProcess(random)], pickWrite(random), 4096 * pickPages(random)));
+		advance(interval);
+
+		// About eight requests stay in flight, a random one completes
+		while (pending.size() > 8)
+		{
+			std::uniform_int_distribution<size_t> pickPending(0, pending.size() - 1);
+			size_t index = pickPending(random);
+			complete(pending[index]);
+			pending[index] = pending.back();
+			pending.pop_back();
+		}
+	}
+
+	for (uint64_t irp : pending)
+	{
+		complete(irp);
+	}
+}
+
+const std::vector<DiskIoTracer::Event>& DiskIoEventStream::getEvents() const
+{
+	return events;
+}
+
+uint64_t DiskIoEventStream::getReadBytes(uint32_t pid) const
+{
+	auto it = readBytes.find(pid);
+	return it != readBytes.end() ? it->second : 0;
+}
+
+uint64_t DiskIoEventStream::getWriteBytes(uint32_t pid) const
+{
+	auto it = writeBytes.find(pid);
+	return it != writeBytes.end() ? it->second : 0;
+}
+
+void DiskIoEventStream::clear()
+{
+	events.clear();
+	readBytes.clear();
+	writeBytes.clear();
+}
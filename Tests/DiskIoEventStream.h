@@ -0,0 +1,185 @@
+/**
+ * @file DiskIoEventStream.h
+ * @brief Implementation of the synthetic disk event stream used by the tests.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "DiskIoTracer.h"
+
+/**
+ * @class DiskIoEventStream
+ * @brief Builds a stream of kernel disk events as the trace session would deliver it.
+ *
+ * The requests are initiated by the processes and completed later in any order, their addresses are
+ * reused once completed like the kernel reuses its IRPs. The stream keeps the bytes each process
+ * really transferred so the accounting of the tracer can be checked against it.
+ */
+class DiskIoEventStream
+{
+	public:
+
+		/**
+		* @brief Builds an empty stream
+		*
+		* @param {uint32_t} seed - The seed of the random order of the completions
+		*/
+		explicit DiskIoEventStream(uint32_t seed);
+
+		/**
+		* @brief Moves the time of the next events forward
+		* @function advance
+		* @param {uint64_t} duration - The time elapsed, in 100ns units
+		*/
+		void advance(uint64_t duration);
+
+		/**
+		* @brief Adds the start of a process
+		* @function startProcess
+		* @param {uint32_t} pid - The pid of the process
+		*/
+		void startProcess(uint32_t pid);
+
+		/**
+		* @brief Adds the end of a process
+		* @function endProcess
+		* @param {uint32_t} pid - The pid of the process
+		*/
+		void endProcess(uint32_t pid);
+
+		/**
+		* @brief Adds the initiation of a request, completed by a later call to complete
+		* @function issue
+		* @param {uint32_t} pid - The pid of the issuing process
+		* @param {bool} write - true for a write, false for a read
+		* @param {uint32_t} size - The bytes transferred
+		* @returns {uint64_t} the address of the request
+		*/
+		uint64_t issue(uint32_t pid, bool write, uint32_t size);
+
+		/**
+		* @brief Adds the completion of a request and counts its bytes for its process
+		* @function complete
+		* @param {uint64_t} irp - The address returned by issue
+		*/
+		void complete(uint64_t irp);
+
+		/**
+		* @brief Forgets a request without completing it, as when the trace loses an event
+		* @function lose
+		* @param {uint64_t} irp - The address returned by issue
+		*/
+		void lose(uint64_t irp);
+
+		/**
+		* @brief Completes the requests in flight in a random order
+		* @function completeAll
+		*/
+		void completeAll();
+
+		/**
+		* @brief Adds a random workload, each process keeps a few requests in flight that complete out of order
+		* @function addWorkload
+		* @param {std::vector<uint32_t>} pids - The processes issuing the requests, already started
+		* @param {size_t} requestCount - The number of requests
+		* @param {uint64_t} interval - The time between two requests, in 100ns units
+		*/
+		void addWorkload(const std::vector<uint32_t>& pids, size_t requestCount, uint64_t interval);
+
+		/**
+		* @brief Gets the events added so far
+		* @function getEvents
+		* @returns {std::vector<DiskIoTracer::Event>} the events
+		*/
+		const std::vector<DiskIoTracer::Event>& getEvents() const;
+
+		/**
+		* @brief Gets the bytes read by a process through the completed requests
+		* @function getReadBytes
+		* @param {uint32_t} pid - The pid of the process
+		* @returns {uint64_t} the bytes read
+		*/
+		uint64_t getReadBytes(uint32_t pid) const;
+
+		/**
+		* @brief Gets the bytes written by a process through the completed requests
+		* @function getWriteBytes
+		* @param {uint32_t} pid - The pid of the process
+		* @returns {uint64_t} the bytes written
+		*/
+		uint64_t getWriteBytes(uint32_t pid) const;
+
+		/**
+		* @brief Forgets the events and the bytes counted, the requests in flight and the time are kept
+		* @function clear
+		*/
+		void clear();
+
+	private:
+
+		/**
+		* @struct Request
+		* @brief A request in flight
+		*/
+		struct Request
+		{
+			uint32_t pid;
+			bool write;
+			uint32_t size;
+		};
+
+		/**
+		* @var {uint64_t} now
+		* @brief The timestamp of the next events
+		*/
+		uint64_t now = 1;
+
+		/**
+		* @var {std::mt19937} random
+		* @brief The generator of the completion order and the sizes
+		*/
+		std::mt19937 random;
+
+		/**
+		* @var {std::vector<DiskIoTracer::Event>} events
+		* @brief The events added so far
+		*/
+		std::vector<DiskIoTracer::Event> events;
+
+		/**
+		* @var {std::unordered_map<uint64_t, Request>} inFlight
+		* @brief The requests issued and not completed yet
+		*/
+		std::unordered_map<uint64_t, Request> inFlight;
+
+		/**
+		* @var {std::vector<uint64_t>} freeAddresses
+		* @brief The addresses of the completed requests, reused first
+		*/
+		std::vector<uint64_t> freeAddresses;
+
+		/**
+		* @var {uint64_t} nextAddress
+		* @brief The next address never used
+		*/
+		uint64_t nextAddress = 0xffffa00000001000ULL;
+
+		/**
+		* @var {std::unordered_map<uint32_t, uint64_t>} readBytes
+		* @brief The bytes read by each process
+		*/
+		std::unordered_map<uint32_t, uint64_t> readBytes;
+
+		/**
+		* @var {std::unordered_map<uint32_t, uint64_t>} writeBytes
+		* @brief The bytes written by each process
+		*/
+		std::unordered_map<uint32_t, uint64_t> writeBytes;
+};
@@ -0,0 +1,141 @@
+/**
+ * @file DiskIoTracerTests.cpp
+ * @brief Tests of the disk I/O accounting driven by synthetic event streams.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "Test.h"
+
+#include "DiskIoEventStream.h"
+#include "DiskIoTracer.h"
+
+/**
+ * @var {uint64_t} MILLISECOND
+ * @brief One millisecond in the 100ns units of the events
+ */
+static constexpr uint64_t MILLISECOND = 10000;
+
+TEST_CASE("Disk bytes are attributed to the process that issued each request")
+{
+	DiskIoTracer tracer;
+	DiskIoEventStream stream(1);
+	std::vector<uint32_t> pids = { 4, 1200, 1204, 3300, 3304, 3308, 7000, 9996 };
+	for (uint32_t pid : pids)
+	{
+		stream.startProcess(pid);
+	}
+	stream.addWorkload(pids, 20000, MILLISECOND / 10);
+	tracer.replay(stream.getEvents());
+
+	for (uint32_t pid : pids)
+	{
+		uint64_t readBytes = 0, writeBytes = 0;
+		REQUIRE(tracer.takeBytes(static_cast<int>(pid), readBytes, writeBytes));
+		CHECK(readBytes == stream.getReadBytes(pid));
+		CHECK(writeBytes == stream.getWriteBytes(pid));
+
+		// The bytes are only given once
+		REQUIRE(tracer.takeBytes(static_cast<int>(pid), readBytes, writeBytes));
+		CHECK(readBytes == 0 && writeBytes == 0);
+	}
+	CHECK(tracer.getDroppedEvents() == 0);
+}
+
+TEST_CASE("Disk requests without completion are evicted and not counted")
+{
+	DiskIoTracer tracer;
+	DiskIoEventStream stream(2);
+	stream.startProcess(100);
+	stream.lose(stream.issue(100, false, 8192));
+	stream.advance(DiskIoTracer::IRP_TIMEOUT + MILLISECOND);
+	stream.complete(stream.issue(100, true, 4096));
+	tracer.replay(stream.getEvents());
+
+	uint64_t readBytes = 0, writeBytes = 0;
+	REQUIRE(tracer.takeBytes(100, readBytes, writeBytes));
+	CHECK(readBytes == 0);
+	CHECK(writeBytes == 4096);
+}
+
+TEST_CASE("Disk counters restart when a pid is reused")
+{
+	DiskIoTracer tracer;
+	DiskIoEventStream stream(3);
+	stream.startProcess(100);
+	stream.complete(stream.issue(100, false, 4096));
+	stream.endProcess(100);
+	stream.advance(MILLISECOND);
+	stream.startProcess(100);
+	stream.complete(stream.issue(100, false, 512));
+	tracer.replay(stream.getEvents());
+
+	uint64_t readBytes = 0, writeBytes = 0;
+	REQUIRE(tracer.takeBytes(100, readBytes, writeBytes));
+	CHECK(readBytes == 512);
+}
+
+TEST_CASE("Disk counters of an ended process are kept for its last requests")
+{
+	DiskIoTracer tracer;
+	DiskIoEventStream stream(4);
+	stream.startProcess(100);
+	uint64_t irp = stream.issue(100, true, 65536);
+	stream.endProcess(100);
+	stream.advance(MILLISECOND);
+	stream.complete(irp);
+	tracer.replay(stream.getEvents());
+
+	uint64_t readBytes = 0, writeBytes = 0;
+	REQUIRE(tracer.takeBytes(100, readBytes, writeBytes));
+	CHECK(writeBytes == 65536);
+
+	// Any later event releases the slot once the delay is over
+	stream.clear();
+	stream.advance(DiskIoTracer::RELEASE_DELAY);
+	stream.startProcess(200);
+	tracer.replay(stream.getEvents());
+	CHECK(!tracer.takeBytes(100, readBytes, writeBytes));
+	CHECK(tracer.getTrackedProcesses() == 1);
+}
+
+TEST_CASE("Disk slots of ended processes are reused")
+{
+	DiskIoTracer tracer;
+	DiskIoEventStream stream(5);
+
+	// Many more processes than slots, but never more than a few hundred alive or waiting for their release
+	const uint32_t processCount = 10 * static_cast<uint32_t>(DiskIoTracer::PID_CAPACITY);
+	for (uint32_t i = 1; i <= processCount; i++)
+	{
+		uint32_t pid = 4 * i;
+		stream.startProcess(pid);
+		stream.complete(stream.issue(pid, false, 4096));
+		stream.endProcess(pid);
+		stream.advance(DiskIoTracer::RELEASE_DELAY / 200);
+	}
+	tracer.replay(stream.getEvents());
+
+	CHECK(tracer.getDroppedEvents() == 0);
+	CHECK(tracer.getTrackedProcesses() <= 201);
+
+	uint64_t readBytes = 0, writeBytes = 0;
+	REQUIRE(tracer.takeBytes(static_cast<int>(4 * processCount), readBytes, writeBytes));
+	CHECK(readBytes == 4096);
+	CHECK(!tracer.takeBytes(4, readBytes, writeBytes));
+}
+
+TEST_CASE("Disk requests of a process are dropped once every slot is taken")
+{
+	DiskIoTracer tracer;
+	DiskIoEventStream stream(6);
+	for (uint32_t i = 1; i <= DiskIoTracer::PID_CAPACITY; i++)
+	{
+		stream.startProcess(4 * i);
+	}
+	stream.complete(stream.issue(4 * (static_cast<uint32_t>(DiskIoTracer::PID_CAPACITY) + 1), false, 4096));
+	tracer.replay(stream.getEvents());
+
+	CHECK(tracer.getTrackedProcesses() == DiskIoTracer::PID_CAPACITY - 1);
+	CHECK(tracer.getDroppedEvents() == 1);
+}
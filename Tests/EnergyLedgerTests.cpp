@@ -0,0 +1,178 @@
+/**
+ * @file EnergyLedgerTests.cpp
+ * @brief Tests of the energy columns of the monitored applications.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "Test.h"
+
+#include "EnergyLedger.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Gets the time at an offset from a fixed origin
+ * @function at
+ * @param {int} ms - The offset in milliseconds
+ * @returns {EnergyLedger::Clock::time_point} the time
+ */
+static EnergyLedger::Clock::time_point at(int ms)
+{
+	return EnergyLedger::Clock::time_point() + std::chrono::milliseconds(ms);
+}
+
+TEST_CASE("Energy ledger sums the ticks of each application")
+{
+	std::unique_ptr<EnergyLedger> ledger(new EnergyLedger());
+	AppId first = { 0, 1 };
+	AppId second = { 2, 1 };
+	ledger->claim(ComponentType::CPU, first);
+	ledger->claim(ComponentType::CPU, second);
+
+	EnergyLedger::Batch batch;
+	batch.clear(3);
+	batch.set(first, 1.5);
+	batch.set(second, 2.0);
+	ledger->accumulate(ComponentType::CPU, batch, at(100));
+
+	// The second application is not sampled on this tick, its last update stays
+	batch.clear(3);
+	batch.set(first, 0.5);
+	ledger->accumulate(ComponentType::CPU, batch, at(200));
+
+	const double watts[] = { 5.0, 0.0, 20.0 };
+	const uint32_t generations[] = { 1, 1, 1 };
+	ledger->setPowers(ComponentType::CPU, watts, generations, 3);
+
+	std::vector<EnergyLedger::Reading> readings;
+	AppId unclaimed = { 1, 1 };
+	ledger->read(ComponentType::CPU, { first, second, unclaimed }, readings);
+	REQUIRE(readings.size() == 3);
+	CHECK_NEAR(readings[0].joules, 2.0, 1e-9);
+	CHECK_NEAR(readings[0].watts, 5.0, 1e-9);
+	CHECK(readings[0].updated == at(200));
+	CHECK_NEAR(readings[1].joules, 2.0, 1e-9);
+	CHECK_NEAR(readings[1].watts, 20.0, 1e-9);
+	CHECK(readings[1].updated == at(100));
+	CHECK(readings[2].joules == 0.0 && readings[2].watts == 0.0);
+
+	// The columns are apart
+	ledger->read(ComponentType::GPU, { first }, readings);
+	CHECK(readings[0].joules == 0.0);
+}
+
+TEST_CASE("Energy ledger starts a reused slot from zero")
+{
+	std::unique_ptr<EnergyLedger> ledger(new EnergyLedger());
+	AppId removed = { 4, 1 };
+	AppId reused = { 4, 2 };
+
+	EnergyLedger::Batch batch;
+	ledger->claim(ComponentType::SD, removed);
+	batch.clear(5);
+	batch.set(removed, 3.0);
+	ledger->accumulate(ComponentType::SD, batch, at(100));
+	const double watts[] = { 0.0, 0.0, 0.0, 0.0, 30.0 };
+	const uint32_t generations[] = { 0, 0, 0, 0, 1 };
+	ledger->setPowers(ComponentType::SD, watts, generations, 5);
+
+	// Before its first tick the new application has nothing, not even the power of the removed one
+	ledger->claim(ComponentType::SD, reused);
+	std::vector<EnergyLedger::Reading> readings;
+	ledger->read(ComponentType::SD, { reused, removed }, readings);
+	CHECK(readings[0].joules == 0.0 && readings[0].watts == 0.0);
+	CHECK(readings[0].updated == EnergyLedger::Clock::time_point());
+	CHECK(readings[1].joules == 0.0 && readings[1].watts == 0.0);
+
+	batch.clear(5);
+	batch.set(reused, 1.0);
+	ledger->accumulate(ComponentType::SD, batch, at(200));
+	ledger->read(ComponentType::SD, { reused }, readings);
+	CHECK_NEAR(readings[0].joules, 1.0, 1e-9);
+	CHECK(readings[0].updated == at(200));
+	CHECK(readings[0].watts == 0.0);
+
+	// Its own power shows from the next frame
+	const double reusedWatts[] = { 0.0, 0.0, 0.0, 0.0, 10.0 };
+	const uint32_t reusedGenerations[] = { 0, 0, 0, 0, 2 };
+	ledger->setPowers(ComponentType::SD, reusedWatts, reusedGenerations, 5);
+	ledger->read(ComponentType::SD, { reused }, readings);
+	CHECK_NEAR(readings[0].watts, 10.0, 1e-9);
+
+	// Claiming again with the same identifier keeps the energy
+	ledger->claim(ComponentType::SD, reused);
+	ledger->read(ComponentType::SD, { reused }, readings);
+	CHECK_NEAR(readings[0].joules, 1.0, 1e-9);
+}
+
+TEST_CASE("Energy ledger readers never see a tick half published")
+{
+	std::unique_ptr<EnergyLedger> ledger(new EnergyLedger());
+	const size_t appCount = 256;
+	const int tickCount = 2000;
+
+	std::vector<AppId> ids;
+	for (uint32_t slot = 0; slot < appCount; slot++)
+	{
+		ids.push_back({ slot, 1 });
+		ledger->claim(ComponentType::NIC, ids.back());
+	}
+
+	// Every application gets 1 J per tick and the same power per frame, a consistent read has equal values
+	std::atomic<bool> done{ false };
+	std::thread sampler([&]
+	{
+		EnergyLedger::Batch batch;
+		for (int tick = 1; tick <= tickCount; tick++)
+		{
+			batch.clear(appCount);
+			for (AppId id : ids)
+			{
+				batch.set(id, 1.0);
+			}
+			ledger->accumulate(ComponentType::NIC, batch, at(tick));
+		}
+		done.store(true);
+	});
+	std::thread clock([&]
+	{
+		std::vector<double> watts(appCount);
+		std::vector<uint32_t> generations(appCount, 1);
+		for (int frame = 1; !done.load(); frame++)
+		{
+			watts.assign(appCount, static_cast<double>(frame));
+			ledger->setPowers(ComponentType::NIC, watts.data(), generations.data(), watts.size());
+		}
+	});
+
+	std::vector<EnergyLedger::Reading> readings;
+	size_t tornReads = 0;
+	double previous = 0.0;
+	bool monotonic = true;
+	while (!done.load())
+	{
+		ledger->read(ComponentType::NIC, ids, readings);
+		for (const EnergyLedger::Reading& reading : readings)
+		{
+			if (reading.joules != readings[0].joules || reading.watts != readings[0].watts || reading.updated != readings[0].updated)
+			{
+				tornReads++;
+				break;
+			}
+		}
+		monotonic = monotonic && readings[0].joules >= previous;
+		previous = readings[0].joules;
+	}
+	sampler.join();
+	clock.join();
+
+	CHECK(tornReads == 0);
+	CHECK(monotonic);
+	ledger->read(ComponentType::NIC, ids, readings);
+	CHECK(readings[appCount - 1].joules == static_cast<double>(tickCount));
+	CHECK(readings[appCount - 1].updated == at(tickCount));
+}
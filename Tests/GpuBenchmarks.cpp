@@ -0,0 +1,91 @@
+/**
+ * @file GpuBenchmarks.cpp
+ * @brief Benchmarks of the GPU attribution against the NVML stub.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "Test.h"
+
+#include "GPU.h"
+#include "NvmlStub/NvmlStub.h"
+
+/**
+ * @var {unsigned int} DEVICE_COUNT
+ * @brief The number of stub devices
+ */
+static constexpr unsigned int DEVICE_COUNT = 2;
+
+/**
+ * @var {size_t} TICKS
+ * @brief The number of ticks of each measured loop
+ */
+static constexpr size_t TICKS = 200;
+
+/**
+ * @var {unsigned int} PIDS_PER_APP
+ * @brief The number of processes of each application whose energy is read
+ */
+static constexpr unsigned int PIDS_PER_APP = 10;
+
+/**
+ * @brief Samples the devices and reads the energy of every application, as the GPU sampler does each tick
+ *
+ * The stub is filled again before each tick, its cost is part of the measure.
+ *
+ * @function runTicks
+ * @param {unsigned int} processCount - The number of processes running on each device
+ * @param {bool} processSamples - false to only give the utilization of the whole devices
+ * @returns {std::chrono::steady_clock::duration} the time of the loop
+ */
+static std::chrono::steady_clock::duration runTicks(unsigned int processCount, bool processSamples)
+{
+	std::vector<std::unordered_set<int>> apps(processCount / PIDS_PER_APP);
+	for (unsigned int pid = 0; pid < processCount; pid++)
+	{
+		apps[pid / PIDS_PER_APP].insert(static_cast<int>(pid + 1));
+	}
+
+	GPU::shutdownNVML();
+	nvmlStubReset(DEVICE_COUNT);
+	GPU::sampleDevices();
+
+	double total = 0.0;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t tick = 0; tick < TICKS; tick++)
+	{
+		nvmlStubReset(DEVICE_COUNT);
+		for (unsigned int device = 0; device < DEVICE_COUNT; device++)
+		{
+			nvmlStubSetSupport(device, true, processSamples);
+			nvmlStubSetUtilization(device, 50);
+			nvmlStubAddEnergy(device, 1000);
+			for (unsigned int pid = 1; pid <= processCount; pid++)
+			{
+				nvmlStubAddProcess(device, pid);
+				if (processSamples)
+				{
+					nvmlStubAddProcessSample(device, pid, 1, 0, 0);
+				}
+			}
+		}
+
+		std::vector<GPU::DeviceSample> samples = GPU::sampleDevices();
+		for (const std::unordered_set<int>& pids : apps)
+		{
+			total += GPU::getGPUJoules(samples, pids)[0];
+		}
+	}
+	auto elapsed = std::chrono::steady_clock::now() - start;
+
+	CHECK(total > 0.0);
+	return elapsed;
+}
+
+BENCHMARK("GPU tick")
+{
+	Test::report("10 processes per device", TICKS, runTicks(10, true));
+	Test::report("100 processes per device", TICKS, runTicks(100, true));
+	Test::report("1000 processes per device", TICKS, runTicks(1000, true));
+	Test::report("1000 processes per device without per-process samples", TICKS, runTicks(1000, false));
+}
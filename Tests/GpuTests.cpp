@@ -0,0 +1,193 @@
+/**
+ * @file GpuTests.cpp
+ * @brief Tests of the GPU attribution against the NVML stub.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "Test.h"
+
+#include "GPU.h"
+#include "NvmlStub/NvmlStub.h"
+
+/**
+ * @var {unsigned int} DEVICE_COUNT
+ * @brief The number of stub devices
+ */
+static constexpr unsigned int DEVICE_COUNT = 2;
+
+/**
+ * @brief Empties the stub devices and reads them once, so the next sample only sees what the test adds
+ *
+ * NVML is initialized again, what GPU.cpp kept about the devices in a previous case (a missing energy
+ * counter, the last timestamps) does not depend on the order of the cases.
+ *
+ * @function startTick
+ */
+static void startTick()
+{
+	GPU::shutdownNVML();
+	nvmlStubReset(DEVICE_COUNT);
+	GPU::sampleDevices();
+}
+
+/**
+ * @brief Gets the share of a pid in a sample
+ * @function findShare
+ * @param {GPU::DeviceSample} sample - The sample of a device
+ * @param {unsigned int} pid - The pid
+ * @returns {double} the share, -1 if the pid is not in the sample
+ */
+static double findShare(const GPU::DeviceSample& sample, unsigned int pid)
+{
+	for (const GPU::ProcessShare& process : sample.processes)
+	{
+		if (process.pid == pid)
+		{
+			return process.share;
+		}
+	}
+	return -1.0;
+}
+
+TEST_CASE("GPU energy is split by the utilization of each process")
+{
+	startTick();
+	nvmlStubAddEnergy(0, 10000);
+	nvmlStubAddProcessSample(0, 100, 30, 0, 0);
+	nvmlStubAddProcessSample(0, 200, 10, 5, 5);
+
+	std::vector<GPU::DeviceSample> samples = GPU::sampleDevices();
+	REQUIRE(samples.size() == DEVICE_COUNT);
+	REQUIRE(samples[0].valid);
+	CHECK_NEAR(samples[0].energy, 10.0, 1e-9);
+	CHECK_NEAR(findShare(samples[0], 100), 0.3, 1e-9);
+	CHECK_NEAR(findShare(samples[0], 200), 0.2, 1e-9);
+
+	std::vector<double> joules = GPU::getGPUJoules(samples, { 100 });
+	CHECK_NEAR(joules[0], 3.0, 1e-9);
+	CHECK_NEAR(joules[1], 0.0, 1e-9);
+
+	joules = GPU::getGPUJoules(samples, { 100, 200, 300 });
+	CHECK_NEAR(joules[0], 5.0, 1e-9);
+}
+
+TEST_CASE("GPU samples already read are not attributed again")
+{
+	startTick();
+	nvmlStubAddProcessSample(0, 100, 50, 0, 0);
+	GPU::sampleDevices();
+
+	nvmlStubAddEnergy(0, 4000);
+	std::vector<GPU::DeviceSample> samples = GPU::sampleDevices();
+	REQUIRE(samples[0].valid);
+	CHECK(samples[0].processes.empty());
+	CHECK_NEAR(GPU::getGPUJoules(samples, { 100 })[0], 0.0, 1e-9);
+}
+
+TEST_CASE("GPU samples of a process are averaged")
+{
+	startTick();
+	nvmlStubAddEnergy(0, 1000);
+	nvmlStubAddProcessSample(0, 100, 20, 0, 0);
+	nvmlStubAddProcessSample(0, 100, 40, 0, 0);
+
+	std::vector<GPU::DeviceSample> samples = GPU::sampleDevices();
+	REQUIRE(samples[0].processes.size() == 1);
+	CHECK_NEAR(findShare(samples[0], 100), 0.3, 1e-9);
+}
+
+TEST_CASE("GPU shares above the whole device are scaled down")
+{
+	startTick();
+	nvmlStubAddEnergy(0, 1000);
+	nvmlStubAddProcessSample(0, 100, 90, 0, 0);
+	nvmlStubAddProcessSample(0, 200, 60, 0, 50);
+
+	std::vector<GPU::DeviceSample> samples = GPU::sampleDevices();
+	CHECK_NEAR(findShare(samples[0], 100), 0.45, 1e-9);
+	CHECK_NEAR(findShare(samples[0], 200), 0.55, 1e-9);
+	CHECK_NEAR(GPU::getGPUJoules(samples, { 100, 200 })[0], 1.0, 1e-9);
+}
+
+TEST_CASE("GPU sample buffer grows with the number of processes")
+{
+	startTick();
+	nvmlStubAddEnergy(1, 2000);
+	for (unsigned int pid = 1; pid <= 100; pid++)
+	{
+		nvmlStubAddProcessSample(1, pid, 1, 0, 0);
+	}
+
+	std::vector<GPU::DeviceSample> samples = GPU::sampleDevices();
+	CHECK(nvmlStubGetInsufficientSizeCount() > 0);
+	REQUIRE(samples[1].processes.size() == 100);
+	CHECK_NEAR(findShare(samples[1], 1), 0.01, 1e-9);
+	CHECK_NEAR(findShare(samples[1], 100), 0.01, 1e-9);
+	CHECK_NEAR(GPU::getGPUJoules(samples, { 1, 2 })[1], 0.04, 1e-9);
+}
+
+TEST_CASE("GPU utilization is split between the running processes without per-process samples")
+{
+	startTick();
+	nvmlStubSetSupport(0, true, false);
+	nvmlStubSetUtilization(0, 40);
+	nvmlStubAddProcess(0, 100);
+	nvmlStubAddProcess(0, 200);
+	nvmlStubAddEnergy(0, 5000);
+
+	std::vector<GPU::DeviceSample> samples = GPU::sampleDevices();
+	REQUIRE(samples[0].valid);
+	CHECK(samples[0].utilization == 40);
+	CHECK_NEAR(findShare(samples[0], 100), 0.2, 1e-9);
+	CHECK_NEAR(findShare(samples[0], 200), 0.2, 1e-9);
+	CHECK_NEAR(GPU::getGPUJoules(samples, { 200 })[0], 1.0, 1e-9);
+	CHECK_NEAR(GPU::getGPUJoules(samples, { 100, 200 })[0], 2.0, 1e-9);
+}
+
+TEST_CASE("GPU power is read when the device has no energy counter")
+{
+	startTick();
+	nvmlStubSetSupport(1, false, true);
+	nvmlStubSetPowerUsage(1, 25000);
+	nvmlStubAddProcessSample(1, 100, 50, 0, 0);
+
+	std::vector<GPU::DeviceSample> samples = GPU::sampleDevices();
+	REQUIRE(samples[1].valid);
+	CHECK_NEAR(samples[1].power, 25.0, 1e-9);
+	CHECK_NEAR(findShare(samples[1], 100), 0.5, 1e-9);
+	CHECK_NEAR(GPU::getGPUJoules(samples, { 100 })[1], 0.5 * samples[1].energy, 1e-9);
+}
+
+TEST_CASE("GPU energy counter is read again once NVML is initialized again")
+{
+	startTick();
+	nvmlStubSetSupport(0, false, true);
+	nvmlStubSetPowerUsage(0, 25000);
+	GPU::sampleDevices();
+
+	startTick();
+	nvmlStubAddEnergy(0, 4000);
+	std::vector<GPU::DeviceSample> samples = GPU::sampleDevices();
+	REQUIRE(samples[0].valid);
+	CHECK_NEAR(samples[0].energy, 4.0, 1e-9);
+}
+
+TEST_CASE("GPU device with per-process samples is kept when its utilization can not be read")
+{
+	startTick();
+	nvmlStubSetDeviceQueriesFailing(0, true);
+	nvmlStubAddEnergy(0, 10000);
+	nvmlStubAddProcessSample(0, 100, 30, 0, 0);
+
+	std::vector<GPU::DeviceSample> samples = GPU::sampleDevices();
+	REQUIRE(samples[0].valid);
+	CHECK_NEAR(findShare(samples[0], 100), 0.3, 1e-9);
+	CHECK_NEAR(GPU::getGPUJoules(samples, { 100 })[0], 3.0, 1e-9);
+
+	// Without per-process samples the failed reads leave nothing to attribute
+	nvmlStubSetSupport(0, true, false);
+	nvmlStubAddProcess(0, 100);
+	samples = GPU::sampleDevices();
+	CHECK(!samples[0].valid);
+}
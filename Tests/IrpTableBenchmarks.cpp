@@ -0,0 +1,125 @@
+/**
+ * @file IrpTableBenchmarks.cpp
+ * @brief Benchmarks of the table of the disk requests in flight.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "Test.h"
+
+#include "DiskIoTracer.h"
+#include "IrpTable.h"
+#include "NetworkEventFixture.h"
+#include "NetworkTracer.h"
+
+#include <map>
+#include <vector>
+
+/**
+ * @var {size_t} OPERATIONS
+ * @brief The number of requests inserted and completed by each measured loop
+ */
+static constexpr size_t OPERATIONS = 4000000;
+
+/**
+ * @brief Inserts and completes requests with a fixed number in flight, like a busy disk
+ * @function runInFlight
+ * @param {size_t} inFlight - The number of requests waiting for their completion
+ * @returns {std::chrono::steady_clock::duration} the time of the loop
+ */
+static std::chrono::steady_clock::duration runInFlight(size_t inFlight)
+{
+	IrpTable table(DiskIoTracer::IRP_CAPACITY, DiskIoTracer::IRP_TIMEOUT);
+	std::vector<uint64_t> ring(inFlight, 0);
+	IrpTable::Entry entry = {};
+	entry.pid = 1234;
+
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < OPERATIONS; i++)
+	{
+		// The oldest request completes, a new one takes its place
+		uint64_t& irp = ring[i % inFlight];
+		IrpTable::Entry taken;
+		table.take(irp, taken);
+
+		irp = 0xffffa00000000000ULL + (i << 8);
+		entry.irp = irp;
+		entry.issuedAt = i;
+		table.insert(entry);
+	}
+	return std::chrono::steady_clock::now() - start;
+}
+
+BENCHMARK("IRP table insert and complete")
+{
+	Test::report("8 requests in flight", OPERATIONS, runInFlight(8));
+	Test::report("1024 requests in flight", OPERATIONS, runInFlight(1024));
+	Test::report("12000 requests in flight (73% full)", OPERATIONS, runInFlight(12000));
+	Test::report("15000 requests in flight (92% full)", OPERATIONS, runInFlight(15000));
+}
+
+BENCHMARK("IRP std::map baseline insert and complete")
+{
+	// The structure the table replaced, without the name copied in every entry
+	std::map<uint64_t, IrpTable::Entry> irps;
+	std::vector<uint64_t> ring(1024, 0);
+	IrpTable::Entry entry = {};
+
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < OPERATIONS; i++)
+	{
+		uint64_t& irp = ring[i % ring.size()];
+		irps.erase(irp);
+
+		irp = 0xffffa00000000000ULL + (i << 8);
+		entry.irp = irp;
+		entry.issuedAt = i;
+		irps[irp] = entry;
+	}
+	Test::report("1024 requests in flight", OPERATIONS, std::chrono::steady_clock::now() - start);
+}
+
+BENCHMARK("DiskIoTracer replay")
+{
+	// Every request goes through the table and the per-pid counters
+	std::vector<DiskIoTracer::Event> events;
+	events.reserve(2 * OPERATIONS);
+	for (uint32_t pid = 4; pid <= 4 * 64; pid += 4)
+	{
+		events.push_back({ DiskIoTracer::EventType::ProcessStart, 0, pid, 0, 1 });
+	}
+	for (size_t i = 0; i < OPERATIONS; i++)
+	{
+		uint64_t irp = 0xffffa00000000000ULL + ((i % 32) << 8);
+		uint32_t pid = static_cast<uint32_t>(4 * (1 + i % 64));
+		events.push_back({ DiskIoTracer::EventType::ReadInit, irp, pid, 0, i });
+		events.push_back({ DiskIoTracer::EventType::ReadComplete, irp, 0, 4096, i });
+	}
+
+	DiskIoTracer tracer;
+	auto start = std::chrono::steady_clock::now();
+	tracer.replay(events);
+	Test::report("requests", OPERATIONS, std::chrono::steady_clock::now() - start);
+}
+
+BENCHMARK("NetworkTracer replay")
+{
+	// The recorded capture again and again, later each time, so the processes end and their slots are released
+	const std::vector<NetworkTracer::Event>& capture = NetworkEventFixture::getEvents();
+	uint64_t span = capture.back().timestamp - capture.front().timestamp + 1;
+	std::vector<NetworkTracer::Event> events;
+	events.reserve(OPERATIONS);
+	for (uint64_t shift = 0; events.size() + capture.size() <= OPERATIONS; shift += span)
+	{
+		for (NetworkTracer::Event event : capture)
+		{
+			event.timestamp += shift;
+			events.push_back(event);
+		}
+	}
+
+	NetworkTracer tracer;
+	auto start = std::chrono::steady_clock::now();
+	tracer.replay(events);
+	Test::report("events", events.size(), std::chrono::steady_clock::now() - start);
+}
@@ -0,0 +1,106 @@
+/**
+ * @file IrpTableTests.cpp
+ * @brief Tests of the table of the disk requests in flight.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "Test.h"
+
+#include "IrpTable.h"
+
+#include <random>
+#include <unordered_map>
+
+/**
+ * @brief Builds a request
+ * @function makeEntry
+ * @param {uint64_t} irp - The address of the request
+ * @param {uint64_t} issuedAt - The time the request was issued
+ * @returns {IrpTable::Entry} the request, its pid derived from its address
+ */
+static IrpTable::Entry makeEntry(uint64_t irp, uint64_t issuedAt)
+{
+	IrpTable::Entry entry = {};
+	entry.irp = irp;
+	entry.issuedAt = issuedAt;
+	entry.pid = static_cast<uint32_t>(irp >> 4);
+	return entry;
+}
+
+TEST_CASE("IRP table finds every request after removals in the middle of probe chains")
+{
+	IrpTable table(1024, UINT64_MAX);
+	std::unordered_map<uint64_t, uint32_t> expected;
+	std::mt19937 random(7);
+
+	// Aligned addresses from a narrow range collide often, the backward shifts are exercised
+	std::uniform_int_distribution<uint64_t> pickAddress(1, 2048);
+	for (int i = 0; i < 200000; i++)
+	{
+		uint64_t irp = pickAddress(random) << 4;
+		IrpTable::Entry entry;
+		if (expected.count(irp) > 0)
+		{
+			REQUIRE(table.take(irp, entry));
+			CHECK(entry.pid == expected[irp]);
+			expected.erase(irp);
+		}
+		else if (expected.size() < 900)
+		{
+			REQUIRE(table.insert(makeEntry(irp, i)));
+			expected[irp] = static_cast<uint32_t>(irp >> 4);
+		}
+		REQUIRE(table.size() == expected.size());
+	}
+
+	for (const auto& request : expected)
+	{
+		IrpTable::Entry entry;
+		REQUIRE(table.take(request.first, entry));
+		CHECK(entry.pid == request.second);
+	}
+	CHECK(table.size() == 0);
+}
+
+TEST_CASE("IRP table only evicts the expired requests")
+{
+	IrpTable table(64, 1000);
+	for (uint64_t i = 1; i <= 10; i++)
+	{
+		REQUIRE(table.insert(makeEntry(i << 4, i * 100)));
+	}
+
+	CHECK(table.evictOlderThan(501) == 5);
+	CHECK(table.size() == 5);
+
+	IrpTable::Entry entry;
+	CHECK(!table.take(5 << 4, entry));
+	CHECK(table.take(6 << 4, entry));
+}
+
+TEST_CASE("IRP table full of live requests rejects new ones until they expire")
+{
+	IrpTable table(1024, 1000);
+	uint64_t irp = 0x10;
+	while (table.insert(makeEntry(irp, 10)))
+	{
+		irp += 0x10;
+	}
+	CHECK(table.size() == 1023);
+
+	// Nothing can expire yet
+	for (int i = 0; i < 100; i++)
+	{
+		CHECK(!table.insert(makeEntry(irp + 0x10 * i, 500)));
+	}
+
+	// Once the requests are older than the timeout, the next sweep of a full table makes room
+	bool inserted = false;
+	for (int i = 0; i < 100 && !inserted; i++)
+	{
+		inserted = table.insert(makeEntry(irp + 0x10 * i, 2000));
+	}
+	CHECK(inserted);
+	CHECK(table.size() == 1);
+}
@@ -0,0 +1,88 @@
+/**
+ * @file NetworkEventFixture.cpp
+ * @brief Definition of the recorded network event stream used by the tests.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "NetworkEventFixture.h"
+
+/**
+ * @brief Defines the start of the capture and the units of its timestamps
+ * @{
+ */
+static constexpr uint64_t START = 133500000000000000ULL;
+static constexpr uint64_t MILLISECOND = 10000;
+/**
+ * @}
+ */
+
+/**
+ * @brief Defines the processes of the capture
+ * @{
+ */
+static constexpr uint32_t BROWSER = 1234;
+static constexpr uint32_t DNS_CLIENT = 5678;
+static constexpr uint32_t DOWNLOADER = 9012;
+static constexpr uint32_t UPDATER = 7776;
+static constexpr uint32_t SILENT = 3344;
+static constexpr uint32_t UNKNOWN = UINT32_MAX;
+/**
+ * @}
+ */
+
+using EventType = NetworkTracer::EventType;
+
+const std::vector<NetworkTracer::Event>& NetworkEventFixture::getEvents()
+{
+	static const std::vector<NetworkTracer::Event> events =
+	{
+		{ EventType::Receive, BROWSER, 1460, START },
+		{ EventType::Receive, BROWSER, 1460, START + 1 * MILLISECOND },
+		{ EventType::Send, BROWSER, 517, START + 2 * MILLISECOND },
+		{ EventType::Send, 0, 60, START + 3 * MILLISECOND },
+		{ EventType::Receive, DNS_CLIENT, 512, START + 5 * MILLISECOND },
+		{ EventType::Send, DNS_CLIENT, 48, START + 5 * MILLISECOND },
+		{ EventType::ProcessStart, DOWNLOADER, 0, START + 10 * MILLISECOND },
+		{ EventType::Send, DOWNLOADER, 2048, START + 12 * MILLISECOND },
+		{ EventType::Receive, DOWNLOADER, 65535, START + 15 * MILLISECOND },
+		{ EventType::Send, UPDATER, 4000, START + 15 * MILLISECOND },
+		{ EventType::Receive, UPDATER, 16000, START + 16 * MILLISECOND },
+		{ EventType::Receive, BROWSER, 4096, START + 18 * MILLISECOND },
+		{ EventType::Send, UNKNOWN, 100, START + 20 * MILLISECOND },
+		{ EventType::ProcessEnd, UPDATER, 0, START + 20 * MILLISECOND },
+		{ EventType::Receive, DOWNLOADER, 1200, START + 25 * MILLISECOND },
+		{ EventType::ProcessEnd, DOWNLOADER, 0, START + 30 * MILLISECOND },
+		{ EventType::Send, BROWSER, 1024, START + 32 * MILLISECOND },
+		{ EventType::ProcessStart, DOWNLOADER, 0, START + 40 * MILLISECOND },
+		{ EventType::Send, DOWNLOADER, 300, START + 45 * MILLISECOND },
+		{ EventType::Receive, DOWNLOADER, 700, START + 50 * MILLISECOND },
+		{ EventType::Receive, DNS_CLIENT, 128, START + 55 * MILLISECOND },
+		{ EventType::ProcessStart, SILENT, 0, START + 60 * MILLISECOND },
+		{ EventType::ProcessEnd, SILENT, 0, START + 70 * MILLISECOND },
+		{ EventType::Receive, BROWSER, 8192, START + 80 * MILLISECOND },
+		{ EventType::Receive, BROWSER, 100, START + 10500 * MILLISECOND }
+	};
+
+	return events;
+}
+
+const std::vector<NetworkEventFixture::Totals>& NetworkEventFixture::getTotals()
+{
+	// The downloader only keeps the bytes of the process reusing its pid
+	static const std::vector<Totals> totals =
+	{
+		{ BROWSER, 517 + 1024, 1460 + 1460 + 4096 + 8192 + 100 },
+		{ DNS_CLIENT, 48, 512 + 128 },
+		{ DOWNLOADER, 300, 700 }
+	};
+
+	return totals;
+}
+
+const std::vector<uint32_t>& NetworkEventFixture::getUntrackedPids()
+{
+	// The updater ended more than NetworkTracer::RELEASE_DELAY before the last event
+	static const std::vector<uint32_t> pids = { 0, UPDATER, SILENT, UNKNOWN };
+	return pids;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file NetworkEventFixture.h
+ * @brief Implementation of the recorded network event stream used by the tests.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "NetworkTracer.h"
+
+/**
+ * @class NetworkEventFixture
+ * @brief A short capture of Kernel-Network and Kernel-Process events, decoded, with the bytes each process transferred.
+ *
+ * A browser and a DNS client run through the whole capture. A download process starts and ends, then
+ * Windows reuses its pid for another process. A process with network traffic ends early and is
+ * released by the last event. The System process and an unknown owner also send bytes that can not
+ * be attributed.
+ */
+class NetworkEventFixture
+{
+	public:
+
+		/**
+		* @struct Totals
+		* @brief The bytes the tracer must give for a process once the whole capture is replayed
+		*/
+		struct Totals
+		{
+			uint32_t pid;
+			uint64_t sentBytes;
+			uint64_t receivedBytes;
+		};
+
+		/**
+		* @brief Gets the events of the capture
+		* @function getEvents
+		* @returns {std::vector<NetworkTracer::Event>} the events in the order they were emitted
+		*/
+		static const std::vector<NetworkTracer::Event>& getEvents();
+
+		/**
+		* @brief Gets the bytes of the processes still tracked at the end of the capture
+		* @function getTotals
+		* @returns {std::vector<Totals>} the bytes of each process
+		*/
+		static const std::vector<Totals>& getTotals();
+
+		/**
+		* @brief Gets the pids the tracer must not hold counters for at the end of the capture
+		* @function getUntrackedPids
+		* @returns {std::vector<uint32_t>} the pids
+		*/
+		static const std::vector<uint32_t>& getUntrackedPids();
+};
@@ -0,0 +1,112 @@
+/**
+ * @file NetworkTracerTests.cpp
+ * @brief Tests of the network accounting driven by recorded and synthetic event streams.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "Test.h"
+
+#include "NetworkEventFixture.h"
+#include "NetworkTracer.h"
+
+/**
+ * @var {uint64_t} MILLISECOND
+ * @brief One millisecond in the 100ns units of the events
+ */
+static constexpr uint64_t MILLISECOND = 10000;
+
+TEST_CASE("Network bytes of the recorded capture are attributed to each process")
+{
+	NetworkTracer tracer;
+	tracer.replay(NetworkEventFixture::getEvents());
+
+	for (const NetworkEventFixture::Totals& totals : NetworkEventFixture::getTotals())
+	{
+		uint64_t sentBytes = 0, receivedBytes = 0;
+		REQUIRE(tracer.takeBytes(static_cast<int>(totals.pid), sentBytes, receivedBytes));
+		CHECK(sentBytes == totals.sentBytes);
+		CHECK(receivedBytes == totals.receivedBytes);
+
+		// The bytes are only given once
+		REQUIRE(tracer.takeBytes(static_cast<int>(totals.pid), sentBytes, receivedBytes));
+		CHECK(sentBytes == 0 && receivedBytes == 0);
+	}
+
+	for (uint32_t pid : NetworkEventFixture::getUntrackedPids())
+	{
+		uint64_t sentBytes = 0, receivedBytes = 0;
+		CHECK(!tracer.takeBytes(static_cast<int>(pid), sentBytes, receivedBytes));
+	}
+
+	CHECK(tracer.getTrackedProcesses() == NetworkEventFixture::getTotals().size());
+	CHECK(tracer.getDroppedEvents() == 0);
+}
+
+TEST_CASE("Network bytes taken after every event of the capture add up to what each process transferred")
+{
+	NetworkTracer tracer;
+	uint64_t sent[4] = {}, received[4] = {};
+	const uint32_t pids[4] = { 1234, 5678, 9012, 7776 };
+
+	for (const NetworkTracer::Event& event : NetworkEventFixture::getEvents())
+	{
+		tracer.onEvent(event);
+		for (size_t i = 0; i < 4; i++)
+		{
+			uint64_t sentBytes = 0, receivedBytes = 0;
+			if (tracer.takeBytes(static_cast<int>(pids[i]), sentBytes, receivedBytes))
+			{
+				sent[i] += sentBytes;
+				received[i] += receivedBytes;
+			}
+		}
+	}
+
+	// Taken in time, nothing is lost to the end of a process or to the reuse of its pid
+	CHECK(sent[0] == 517 + 1024 && received[0] == 1460 + 1460 + 4096 + 8192 + 100);
+	CHECK(sent[1] == 48 && received[1] == 512 + 128);
+	CHECK(sent[2] == 2048 + 300 && received[2] == 65535 + 1200 + 700);
+	CHECK(sent[3] == 4000 && received[3] == 16000);
+}
+
+TEST_CASE("Network slots of ended processes are reused")
+{
+	NetworkTracer tracer;
+	std::vector<NetworkTracer::Event> events;
+	uint64_t now = 1;
+
+	// Many more processes than slots, but never more than a few hundred alive or waiting for their release
+	const uint32_t processCount = 10 * static_cast<uint32_t>(NetworkTracer::PID_CAPACITY);
+	for (uint32_t i = 1; i <= processCount; i++)
+	{
+		uint32_t pid = 4 * i;
+		events.push_back({ NetworkTracer::EventType::ProcessStart, pid, 0, now });
+		events.push_back({ NetworkTracer::EventType::Send, pid, 1200, now });
+		events.push_back({ NetworkTracer::EventType::ProcessEnd, pid, 0, now });
+		now += NetworkTracer::RELEASE_DELAY / 200;
+	}
+	tracer.replay(events);
+
+	CHECK(tracer.getDroppedEvents() == 0);
+	CHECK(tracer.getTrackedProcesses() <= 201);
+
+	uint64_t sentBytes = 0, receivedBytes = 0;
+	REQUIRE(tracer.takeBytes(static_cast<int>(4 * processCount), sentBytes, receivedBytes));
+	CHECK(sentBytes == 1200);
+	CHECK(!tracer.takeBytes(4, sentBytes, receivedBytes));
+}
+
+TEST_CASE("Network events of a process are dropped once every slot is taken")
+{
+	NetworkTracer tracer;
+	std::vector<NetworkTracer::Event> events;
+	for (uint32_t i = 1; i <= NetworkTracer::PID_CAPACITY; i++)
+	{
+		events.push_back({ NetworkTracer::EventType::Receive, 4 * i, 1500, i * MILLISECOND });
+	}
+	tracer.replay(events);
+
+	CHECK(tracer.getTrackedProcesses() == NetworkTracer::PID_CAPACITY - 1);
+	CHECK(tracer.getDroppedEvents() == 1);
+}
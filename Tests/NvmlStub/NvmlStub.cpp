@@ -0,0 +1,328 @@
+/**
+ * @file NvmlStub.cpp
+ * @brief Definition of the NVML stub used by the tests.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "NvmlStub.h"
+
+#include <vector>
+
+/**
+ * @brief Defines the NVML types and constants used by GPU.cpp, with the same layouts as the driver
+ * @{
+ */
+#define NVML_SUCCESS 0
+#define NVML_ERROR_INVALID_ARGUMENT 2
+#define NVML_ERROR_NOT_SUPPORTED 3
+#define NVML_ERROR_NOT_FOUND 6
+#define NVML_ERROR_INSUFFICIENT_SIZE 7
+#define NVML_ERROR_UNKNOWN 999
+
+typedef int nvmlReturn_t;
+typedef void* nvmlDevice_t;
+
+typedef struct nvmlUtilization_st
+{
+	unsigned int gpu;
+	unsigned int memory;
+} nvmlUtilization_t;
+
+typedef struct nvmlProcessInfo_st
+{
+	unsigned int pid;
+	unsigned long long usedGpuMemory;
+} nvmlProcessInfo_t;
+
+typedef struct nvmlProcessUtilizationSample_st
+{
+	unsigned int pid;
+	unsigned long long timeStamp;
+	unsigned int smUtil;
+	unsigned int memUtil;
+	unsigned int encUtil;
+	unsigned int decUtil;
+} nvmlProcessUtilizationSample_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @struct StubDevice
+ * @brief What the tests described about a device
+ */
+struct StubDevice
+{
+	unsigned int utilization = 0;
+	unsigned int power = 0;
+	unsigned long long energy = 0;
+	bool energySupported = true;
+	bool processUtilizationSupported = true;
+	bool deviceQueriesFailing = false;
+	std::vector<nvmlProcessInfo_t> processes;
+	std::vector<nvmlProcessUtilizationSample_t> samples;
+};
+
+/**
+ * @var {std::vector<StubDevice>} devices
+ * @brief The devices, their handle is their address in the vector
+ */
+static std::vector<StubDevice> devices;
+
+/**
+ * @var {unsigned long long} sampleClock
+ * @brief The timestamp of the last sample added, never reset
+ */
+static unsigned long long sampleClock = 0;
+
+/**
+ * @var {unsigned int} insufficientSizeCount
+ * @brief The number of sample reads answered with NVML_ERROR_INSUFFICIENT_SIZE since the last reset
+ */
+static unsigned int insufficientSizeCount = 0;
+
+/**
+ * @brief Gets the device of a handle
+ * @function toDevice
+ * @param {nvmlDevice_t} handle - The handle given by nvmlDeviceGetHandleByIndex
+ * @returns {StubDevice*} the device, nullptr if the handle is not one of them
+ */
+static StubDevice* toDevice(nvmlDevice_t handle)
+{
+	for (StubDevice& device : devices)
+	{
+		if (&device == handle)
+		{
+			return &device;
+		}
+	}
+	return nullptr;
+}
+
+NVML_STUB_API void nvmlStubReset(unsigned int deviceCount)
+{
+	// The handles are kept by GPU.cpp, the devices are emptied in place when their count does not change
+	if (devices.size() != deviceCount)
+	{
+		devices.resize(deviceCount);
+	}
+
+	for (StubDevice& device : devices)
+	{
+		unsigned long long energy = device.energy;
+		device = StubDevice();
+		device.energy = energy;
+	}
+	insufficientSizeCount = 0;
+}
+
+NVML_STUB_API void nvmlStubSetUtilization(unsigned int device, unsigned int gpu)
+{
+	devices.at(device).utilization = gpu;
+}
+
+NVML_STUB_API void nvmlStubSetPowerUsage(unsigned int device, unsigned int milliwatts)
+{
+	devices.at(device).power = milliwatts;
+}
+
+NVML_STUB_API void nvmlStubAddEnergy(unsigned int device, unsigned long long millijoules)
+{
+	devices.at(device).energy += millijoules;
+}
+
+NVML_STUB_API void nvmlStubSetSupport(unsigned int device, bool energy, bool processUtilization)
+{
+	devices.at(device).energySupported = energy;
+	devices.at(device).processUtilizationSupported = processUtilization;
+}
+
+NVML_STUB_API void nvmlStubSetDeviceQueriesFailing(unsigned int device, bool failing)
+{
+	devices.at(device).deviceQueriesFailing = failing;
+}
+
+NVML_STUB_API void nvmlStubAddProcess(unsigned int device, unsigned int pid)
+{
+	devices.at(device).processes.push_back({ pid, 0 });
+}
+
+NVML_STUB_API void nvmlStubAddProcessSample(unsigned int device, unsigned int pid, unsigned int smUtil, unsigned int encUtil, unsigned int decUtil)
+{
+	devices.at(device).samples.push_back({ pid, ++sampleClock, smUtil, 0, encUtil, decUtil });
+}
+
+NVML_STUB_API unsigned int nvmlStubGetInsufficientSizeCount()
+{
+	return insufficientSizeCount;
+}
+
+NVML_STUB_API nvmlReturn_t nvmlInit()
+{
+	return NVML_SUCCESS;
+}
+
+NVML_STUB_API nvmlReturn_t nvmlShutdown()
+{
+	return NVML_SUCCESS;
+}
+
+NVML_STUB_API const char* nvmlErrorString(nvmlReturn_t result)
+{
+	switch (result)
+	{
+		case NVML_SUCCESS:
+			return "Success";
+		case NVML_ERROR_INVALID_ARGUMENT:
+			return "Invalid Argument";
+		case NVML_ERROR_NOT_SUPPORTED:
+			return "Not Supported";
+		case NVML_ERROR_NOT_FOUND:
+			return "Not Found";
+		case NVML_ERROR_INSUFFICIENT_SIZE:
+			return "Insufficient Size";
+		case NVML_ERROR_UNKNOWN:
+			return "Unknown Error";
+		default:
+			return "Unknown Error";
+	}
+}
+
+NVML_STUB_API nvmlReturn_t nvmlDeviceGetCount(unsigned int* deviceCount)
+{
+	*deviceCount = static_cast<unsigned int>(devices.size());
+	return NVML_SUCCESS;
+}
+
+NVML_STUB_API nvmlReturn_t nvmlDeviceGetHandleByIndex(unsigned int index, nvmlDevice_t* device)
+{
+	if (index >= devices.size())
+	{
+		return NVML_ERROR_INVALID_ARGUMENT;
+	}
+
+	*device = &devices[index];
+	return NVML_SUCCESS;
+}
+
+NVML_STUB_API nvmlReturn_t nvmlDeviceGetUtilizationRates(nvmlDevice_t handle, nvmlUtilization_t* utilization)
+{
+	StubDevice* device = toDevice(handle);
+	if (!device)
+	{
+		return NVML_ERROR_INVALID_ARGUMENT;
+	}
+
+	if (device->deviceQueriesFailing)
+	{
+		return NVML_ERROR_UNKNOWN;
+	}
+
+	utilization->gpu = device->utilization;
+	utilization->memory = 0;
+	return NVML_SUCCESS;
+}
+
+NVML_STUB_API nvmlReturn_t nvmlDeviceGetComputeRunningProcesses(nvmlDevice_t handle, unsigned int* infoCount, nvmlProcessInfo_t* infos)
+{
+	StubDevice* device = toDevice(handle);
+	if (!device)
+	{
+		return NVML_ERROR_INVALID_ARGUMENT;
+	}
+
+	if (device->deviceQueriesFailing)
+	{
+		return NVML_ERROR_UNKNOWN;
+	}
+
+	unsigned int count = static_cast<unsigned int>(device->processes.size());
+	if (*infoCount < count)
+	{
+		*infoCount = count;
+		return NVML_ERROR_INSUFFICIENT_SIZE;
+	}
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		infos[i] = device->processes[i];
+	}
+	*infoCount = count;
+	return NVML_SUCCESS;
+}
+
+NVML_STUB_API nvmlReturn_t nvmlDeviceGetPowerUsage(nvmlDevice_t handle, unsigned int* power)
+{
+	StubDevice* device = toDevice(handle);
+	if (!device)
+	{
+		return NVML_ERROR_INVALID_ARGUMENT;
+	}
+
+	*power = device->power;
+	return NVML_SUCCESS;
+}
+
+NVML_STUB_API nvmlReturn_t nvmlDeviceGetTotalEnergyConsumption(nvmlDevice_t handle, unsigned long long* energy)
+{
+	StubDevice* device = toDevice(handle);
+	if (!device)
+	{
+		return NVML_ERROR_INVALID_ARGUMENT;
+	}
+
+	if (!device->energySupported)
+	{
+		return NVML_ERROR_NOT_SUPPORTED;
+	}
+
+	*energy = device->energy;
+	return NVML_SUCCESS;
+}
+
+NVML_STUB_API nvmlReturn_t nvmlDeviceGetProcessUtilization(nvmlDevice_t handle, nvmlProcessUtilizationSample_t* utilization, unsigned int* processSamplesCount, unsigned long long lastSeenTimeStamp)
+{
+	StubDevice* device = toDevice(handle);
+	if (!device)
+	{
+		return NVML_ERROR_INVALID_ARGUMENT;
+	}
+
+	if (!device->processUtilizationSupported)
+	{
+		return NVML_ERROR_NOT_SUPPORTED;
+	}
+
+	// Like the driver, only the samples newer than the cursor are returned
+	unsigned int count = 0;
+	for (const nvmlProcessUtilizationSample_t& sample : device->samples)
+	{
+		count += sample.timeStamp > lastSeenTimeStamp ? 1 : 0;
+	}
+
+	if (count == 0)
+	{
+		return NVML_ERROR_NOT_FOUND;
+	}
+
+	if (utilization == nullptr || *processSamplesCount < count)
+	{
+		*processSamplesCount = count;
+		insufficientSizeCount++;
+		return NVML_ERROR_INSUFFICIENT_SIZE;
+	}
+
+	unsigned int written = 0;
+	for (const nvmlProcessUtilizationSample_t& sample : device->samples)
+	{
+		if (sample.timeStamp > lastSeenTimeStamp)
+		{
+			utilization[written++] = sample;
+		}
+	}
+
+	*processSamplesCount = count;
+	return NVML_SUCCESS;
+}
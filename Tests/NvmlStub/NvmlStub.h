@@ -0,0 +1,98 @@
+/**
+ * @file NvmlStub.h
+ * @brief Implementation of the NVML stub used by the tests.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#if !defined(_WIN32)
+#define NVML_STUB_API extern "C" __attribute__((visibility("default")))
+#elif defined(NVMLSTUB_EXPORTS)
+#define NVML_STUB_API extern "C" __declspec(dllexport)
+#else
+#define NVML_STUB_API extern "C" __declspec(dllimport)
+#endif
+
+/**
+ * The stub is built as nvml.dll (libnvml.so.1 off-Windows) next to the tests, so GPU.cpp loads it instead of the driver. It exports
+ * the NVML functions GPU.cpp looks up, answered from devices the tests describe with the functions below.
+ *
+ * The samples get increasing timestamps that are never reset, so the cursor GPU.cpp keeps for each device
+ * stays valid from one test to the next. The energy counters only grow for the same reason.
+ */
+
+/**
+ * @brief Forgets the processes, samples and utilization of every device and sets the number of devices
+ * @function nvmlStubReset
+ * @param {unsigned int} deviceCount - The number of devices, only read by GPU.cpp when NVML is initialized
+ */
+NVML_STUB_API void nvmlStubReset(unsigned int deviceCount);
+
+/**
+ * @brief Sets the utilization of a whole device
+ * @function nvmlStubSetUtilization
+ * @param {unsigned int} device - The index of the device
+ * @param {unsigned int} gpu - The utilization in percent
+ */
+NVML_STUB_API void nvmlStubSetUtilization(unsigned int device, unsigned int gpu);
+
+/**
+ * @brief Sets the power read on a device
+ * @function nvmlStubSetPowerUsage
+ * @param {unsigned int} device - The index of the device
+ * @param {unsigned int} milliwatts - The power in milliwatts
+ */
+NVML_STUB_API void nvmlStubSetPowerUsage(unsigned int device, unsigned int milliwatts);
+
+/**
+ * @brief Adds to the total energy counter of a device
+ * @function nvmlStubAddEnergy
+ * @param {unsigned int} device - The index of the device
+ * @param {unsigned long long} millijoules - The energy added
+ */
+NVML_STUB_API void nvmlStubAddEnergy(unsigned int device, unsigned long long millijoules);
+
+/**
+ * @brief Sets the optional features of a device, both are supported after a reset
+ * @function nvmlStubSetSupport
+ * @param {unsigned int} device - The index of the device
+ * @param {bool} energy - false to answer NVML_ERROR_NOT_SUPPORTED when the energy counter is read
+ * @param {bool} processUtilization - false to answer NVML_ERROR_NOT_SUPPORTED when the samples are read
+ */
+NVML_STUB_API void nvmlStubSetSupport(unsigned int device, bool energy, bool processUtilization);
+
+/**
+ * @brief Makes the reads of the utilization and of the running processes of a device fail until the next reset
+ * @function nvmlStubSetDeviceQueriesFailing
+ * @param {unsigned int} device - The index of the device
+ * @param {bool} failing - true to answer NVML_ERROR_UNKNOWN to nvmlDeviceGetUtilizationRates and nvmlDeviceGetComputeRunningProcesses
+ */
+NVML_STUB_API void nvmlStubSetDeviceQueriesFailing(unsigned int device, bool failing);
+
+/**
+ * @brief Adds a process to the running processes of a device
+ * @function nvmlStubAddProcess
+ * @param {unsigned int} device - The index of the device
+ * @param {unsigned int} pid - The pid of the process
+ */
+NVML_STUB_API void nvmlStubAddProcess(unsigned int device, unsigned int pid);
+
+/**
+ * @brief Adds a utilization sample of a process, newer than every sample added before
+ * @function nvmlStubAddProcessSample
+ * @param {unsigned int} device - The index of the device
+ * @param {unsigned int} pid - The pid of the process
+ * @param {unsigned int} smUtil - The SM utilization in percent
+ * @param {unsigned int} encUtil - The encoder utilization in percent
+ * @param {unsigned int} decUtil - The decoder utilization in percent
+ */
+NVML_STUB_API void nvmlStubAddProcessSample(unsigned int device, unsigned int pid, unsigned int smUtil, unsigned int encUtil, unsigned int decUtil);
+
+/**
+ * @brief Gets the number of calls to nvmlDeviceGetProcessUtilization answered with NVML_ERROR_INSUFFICIENT_SIZE
+ * @function nvmlStubGetInsufficientSizeCount
+ * @returns {unsigned int} the number of calls since the last reset
+ */
+NVML_STUB_API unsigned int nvmlStubGetInsufficientSizeCount();
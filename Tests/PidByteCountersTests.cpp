@@ -0,0 +1,145 @@
+/**
+ * @file PidByteCountersTests.cpp
+ * @brief Tests of the per-pid byte counters shared by the trace consumers.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "Test.h"
+
+#include "PidByteCounters.h"
+
+/**
+ * @var {uint64_t} RELEASE_DELAY
+ * @brief The release delay of the tables of the tests
+ */
+static constexpr uint64_t RELEASE_DELAY = 1000;
+
+TEST_CASE("Pid counters give their bytes once")
+{
+	PidByteCounters counters(RELEASE_DELAY);
+	CHECK(counters.add(4, 0, 100));
+	CHECK(counters.add(4, 1, 20));
+	CHECK(counters.add(4, 0, 5));
+
+	uint64_t first = 0, second = 0;
+	REQUIRE(counters.take(4, first, second));
+	CHECK(first == 105 && second == 20);
+	REQUIRE(counters.take(4, first, second));
+	CHECK(first == 0 && second == 0);
+
+	CHECK(!counters.take(8, first, second));
+	CHECK(!counters.add(0, 0, 1));
+	CHECK(counters.getTrackedProcesses() == 1);
+}
+
+TEST_CASE("Pid counters restart when the pid is given to a new process")
+{
+	PidByteCounters counters(RELEASE_DELAY);
+	counters.add(4, 0, 100);
+	counters.restart(4);
+	counters.add(4, 1, 7);
+
+	// Restarting an unknown pid does not take a slot, tracking it does
+	counters.restart(8);
+	CHECK(counters.getTrackedProcesses() == 1);
+	CHECK(counters.track(8));
+	CHECK(counters.getTrackedProcesses() == 2);
+
+	uint64_t first = 0, second = 0;
+	REQUIRE(counters.take(4, first, second));
+	CHECK(first == 0 && second == 7);
+	REQUIRE(counters.take(8, first, second));
+	CHECK(first == 0 && second == 0);
+}
+
+TEST_CASE("Pid counters of an ended process are released after the delay")
+{
+	PidByteCounters counters(RELEASE_DELAY);
+	counters.add(4, 0, 100);
+	counters.end(4, 10);
+
+	// Still there for the last take until the delay is over
+	counters.releaseEnded(10 + RELEASE_DELAY - 1);
+	uint64_t first = 0, second = 0;
+	REQUIRE(counters.take(4, first, second));
+	CHECK(first == 100);
+
+	counters.releaseEnded(10 + RELEASE_DELAY);
+	CHECK(!counters.take(4, first, second));
+	CHECK(counters.getTrackedProcesses() == 0);
+}
+
+TEST_CASE("Pid counters find every process after releases in the middle of probe chains")
+{
+	PidByteCounters counters(RELEASE_DELAY);
+
+	// Enough processes for long probe chains, every other one ends
+	const uint32_t processCount = static_cast<uint32_t>(PidByteCounters::CAPACITY) / 2;
+	for (uint32_t pid = 1; pid <= processCount; pid++)
+	{
+		REQUIRE(counters.add(4 * pid, 0, pid));
+		if (pid % 2 == 0)
+		{
+			counters.end(4 * pid, 1);
+		}
+	}
+	counters.releaseEnded(1 + RELEASE_DELAY);
+	CHECK(counters.getTrackedProcesses() == processCount / 2);
+
+	uint64_t first = 0, second = 0;
+	for (uint32_t pid = 1; pid <= processCount; pid++)
+	{
+		bool found = counters.take(4 * pid, first, second);
+		CHECK(found == (pid % 2 == 1));
+		CHECK(!found || first == pid);
+	}
+
+	// The released slots are taken again by new processes
+	for (uint32_t pid = processCount + 1; pid <= processCount + processCount / 2; pid++)
+	{
+		REQUIRE(counters.add(4 * pid, 1, 1));
+	}
+	CHECK(counters.getTrackedProcesses() == processCount);
+}
+
+TEST_CASE("Pid counters keep a free slot once full")
+{
+	PidByteCounters counters(RELEASE_DELAY);
+	for (uint32_t pid = 1; pid < PidByteCounters::CAPACITY; pid++)
+	{
+		REQUIRE(counters.track(4 * pid));
+	}
+	CHECK(!counters.add(4 * static_cast<uint32_t>(PidByteCounters::CAPACITY), 0, 1));
+	CHECK(counters.getTrackedProcesses() == PidByteCounters::CAPACITY - 1);
+
+	// Unknown pids are still looked up to the free slot
+	uint64_t first = 0, second = 0;
+	CHECK(!counters.take(3, first, second));
+	CHECK(counters.add(4, 0, 1));
+}
+
+TEST_CASE("Pid counters sweep the table when more processes end within the delay than the ring holds")
+{
+	PidByteCounters counters(RELEASE_DELAY);
+
+	// A pid reused over and over leaves a stale end in the ring each time
+	counters.add(4, 0, 1);
+	for (uint64_t now = 1; now <= PidByteCounters::CAPACITY + 1; now++)
+	{
+		counters.end(4, now);
+		counters.restart(4);
+	}
+	counters.add(8, 0, 1);
+	counters.end(8, 2 * PidByteCounters::CAPACITY);
+	counters.end(4, 2 * PidByteCounters::CAPACITY + 1);
+
+	uint64_t first = 0, second = 0;
+	counters.releaseEnded(2 * PidByteCounters::CAPACITY + RELEASE_DELAY);
+	CHECK(!counters.take(8, first, second));
+	CHECK(counters.take(4, first, second));
+
+	counters.releaseEnded(2 * PidByteCounters::CAPACITY + 1 + RELEASE_DELAY);
+	CHECK(!counters.take(4, first, second));
+	CHECK(counters.getTrackedProcesses() == 0);
+}
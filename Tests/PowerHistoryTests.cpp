@@ -0,0 +1,163 @@
+/**
+ * @file PowerHistoryTests.cpp
+ * @brief Tests of the power history of the monitored applications.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "Test.h"
+
+#include "PowerHistory.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Builds the frame of a tick, its power is the tick and its energy the generation of the application
+ * @function frameAt
+ * @param {uint64_t} tick - The number of seconds since the epoch of the frame end
+ * @param {uint32_t} generation - The generation of the application
+ * @returns {PowerHistory::Sample} the frame
+ */
+static PowerHistory::Sample frameAt(uint64_t tick, uint32_t generation = 1)
+{
+	return { PowerHistory::Clock::time_point() + std::chrono::seconds(tick), static_cast<double>(tick), static_cast<double>(generation) };
+}
+
+/**
+ * @brief Gets the tick of a frame built by frameAt
+ * @function tickOf
+ * @param {PowerHistory::Sample} sample - The frame
+ * @returns {uint64_t} the tick
+ */
+static uint64_t tickOf(const PowerHistory::Sample& sample)
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(sample.timestamp.time_since_epoch()).count());
+}
+
+TEST_CASE("Power history keeps the last frames of the retention")
+{
+	PowerHistory history(4, 5);
+	AppId app = { 2, 1 };
+	for (uint64_t tick = 1; tick <= 12; tick++)
+	{
+		history.append(app, ComponentType::CPU, frameAt(tick));
+	}
+
+	std::vector<PowerHistory::Sample> samples;
+	history.latest(app, ComponentType::CPU, 3, samples);
+	REQUIRE(samples.size() == 3);
+	CHECK(tickOf(samples[0]) == 10 && tickOf(samples[2]) == 12);
+
+	// The spare entry is not given out, only the retention
+	history.latest(app, ComponentType::CPU, 100, samples);
+	REQUIRE(samples.size() == 5);
+	CHECK(tickOf(samples[0]) == 8 && tickOf(samples[4]) == 12);
+
+	history.latest(app, ComponentType::GPU, 100, samples);
+	CHECK(samples.empty());
+	history.latest({ 3, 1 }, ComponentType::CPU, 100, samples);
+	CHECK(samples.empty());
+	history.latest({ 4, 1 }, ComponentType::CPU, 100, samples);
+	CHECK(samples.empty());
+}
+
+TEST_CASE("Power history queries the frames ending between two times, both included")
+{
+	PowerHistory history(1, 8);
+	AppId app = { 0, 1 };
+	for (uint64_t tick = 1; tick <= 10; tick++)
+	{
+		history.append(app, ComponentType::SD, frameAt(tick));
+	}
+
+	std::vector<PowerHistory::Sample> samples;
+	history.query(app, ComponentType::SD, frameAt(4).timestamp, frameAt(6).timestamp, samples);
+	REQUIRE(samples.size() == 3);
+	CHECK(tickOf(samples[0]) == 4 && tickOf(samples[1]) == 5 && tickOf(samples[2]) == 6);
+
+	// A range reaching past the retention only gives the frames kept
+	history.query(app, ComponentType::SD, frameAt(0).timestamp, frameAt(20).timestamp, samples);
+	REQUIRE(samples.size() == 8);
+	CHECK(tickOf(samples[0]) == 3 && tickOf(samples[7]) == 10);
+
+	// Between two frames, or outside of the frames kept
+	history.query(app, ComponentType::SD, frameAt(5).timestamp + std::chrono::milliseconds(1), frameAt(6).timestamp - std::chrono::milliseconds(1), samples);
+	CHECK(samples.empty());
+	history.query(app, ComponentType::SD, frameAt(11).timestamp, frameAt(20).timestamp, samples);
+	CHECK(samples.empty());
+	history.query(app, ComponentType::SD, frameAt(0).timestamp, frameAt(2).timestamp, samples);
+	CHECK(samples.empty());
+}
+
+TEST_CASE("Power history starts a slot reclaimed by a new generation empty")
+{
+	PowerHistory history(1, 4);
+	AppId removed = { 0, 1 };
+	AppId reused = { 0, 2 };
+	history.append(removed, ComponentType::CPU, frameAt(1, 1));
+	history.append(removed, ComponentType::NIC, frameAt(1, 1));
+	history.append(removed, ComponentType::CPU, frameAt(2, 1));
+
+	history.append(reused, ComponentType::CPU, frameAt(3, 2));
+
+	std::vector<PowerHistory::Sample> samples;
+	history.latest(removed, ComponentType::CPU, 10, samples);
+	CHECK(samples.empty());
+
+	// Every ring of the slot is emptied, the ones the new application did not append to yet included
+	history.latest(reused, ComponentType::NIC, 10, samples);
+	CHECK(samples.empty());
+	history.latest(reused, ComponentType::CPU, 10, samples);
+	REQUIRE(samples.size() == 1);
+	CHECK(tickOf(samples[0]) == 3 && samples[0].joules == 2.0);
+}
+
+TEST_CASE("Power history readers only get frames that were not overwritten during their copy")
+{
+	// A short ring so the clock thread laps the readers often, on one application so only the check of
+	// the head after the copy tells the overwritten frames apart
+	const size_t retention = 4;
+	PowerHistory history(1, retention);
+	AppId app = { 0, 1 };
+
+	// Long enough for the readers to be preempted during their copy on a single processor as well
+	std::atomic<bool> done{ false };
+	std::atomic<uint64_t> appended{ 0 };
+	std::thread clock([&]
+	{
+		uint64_t tick = 0;
+		while (!done.load(std::memory_order_relaxed))
+		{
+			history.append(app, ComponentType::CPU, frameAt(++tick));
+		}
+		appended.store(tick);
+	});
+
+	// Every frame given is whole and the frames follow each other
+	std::vector<PowerHistory::Sample> samples;
+	size_t invalidCopies = 0;
+	auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+	while (std::chrono::steady_clock::now() < end)
+	{
+		history.latest(app, ComponentType::CPU, retention, samples);
+		for (size_t i = 0; i < samples.size(); i++)
+		{
+			bool whole = samples[i].watts == static_cast<double>(tickOf(samples[i])) && samples[i].joules == 1.0;
+			bool consecutive = i == 0 || tickOf(samples[i]) == tickOf(samples[i - 1]) + 1;
+			if (!whole || !consecutive)
+			{
+				invalidCopies++;
+				break;
+			}
+		}
+	}
+	done.store(true);
+	clock.join();
+
+	CHECK(invalidCopies == 0);
+	history.latest(app, ComponentType::CPU, retention, samples);
+	REQUIRE(samples.size() == retention);
+	CHECK(tickOf(samples[retention - 1]) == appended.load());
+}
@@ -0,0 +1,179 @@
+/**
+ * @file PowerSourceTests.cpp
+ * @brief Tests of the RAPL power source on a fake powercap directory.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "Test.h"
+
+#ifndef _WIN32
+
+#include "PowerSource.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @class FakePowercap
+ * @brief A temporary powercap directory with the counters of a few packages
+ */
+class FakePowercap
+{
+	public:
+
+		/**
+		* @brief Creates the directory, without package
+		*/
+		FakePowercap()
+		{
+			char path[] = "/tmp/ecofloc-powercap-XXXXXX";
+			root = mkdtemp(path) ? path : "";
+		}
+
+		~FakePowercap()
+		{
+			for (const std::string& file : files)
+			{
+				unlink(file.c_str());
+			}
+			for (auto zone = zones.rbegin(); zone != zones.rend(); ++zone)
+			{
+				rmdir(zone->c_str());
+			}
+			rmdir(root.c_str());
+		}
+
+		/**
+		* @brief Creates the counters of the next package
+		* @function addPackage
+		* @param {uint64_t} energy - The first value of energy_uj
+		* @param {uint64_t} maxRange - The value of max_energy_range_uj, 0 to leave it out
+		*/
+		void addPackage(uint64_t energy, uint64_t maxRange)
+		{
+			std::string zone = root + "/intel-rapl:" + std::to_string(zones.size());
+			mkdir(zone.c_str(), 0700);
+			zones.push_back(zone);
+			setEnergy(zones.size() - 1, energy);
+			if (maxRange != 0)
+			{
+				write(zone + "/max_energy_range_uj", maxRange);
+			}
+		}
+
+		/**
+		* @brief Sets the energy counter of a package
+		* @function setEnergy
+		* @param {size_t} package - The index of the package
+		* @param {uint64_t} energy - The value of energy_uj
+		*/
+		void setEnergy(size_t package, uint64_t energy)
+		{
+			write(zones[package] + "/energy_uj", energy);
+		}
+
+		/**
+		* @brief Gets the directory to give to the source
+		* @function getRoot
+		* @returns {std::string} the directory
+		*/
+		const std::string& getRoot() const
+		{
+			return root;
+		}
+
+	private:
+
+		/**
+		* @brief Replaces the value of a counter file, as the kernel would update it
+		* @param {std::string} file - The path of the file
+		* @param {uint64_t} value - The value
+		*/
+		void write(const std::string& file, uint64_t value)
+		{
+			std::ofstream(file, std::ios::trunc) << value << "\n";
+			files.push_back(file);
+		}
+
+		/**
+		* @var {std::string} root
+		* @brief The temporary directory, empty if it could not be created
+		*/
+		std::string root;
+
+		/**
+		* @var {std::vector<std::string>} zones
+		* @brief The directory of each package
+		*/
+		std::vector<std::string> zones;
+
+		/**
+		* @var {std::vector<std::string>} files
+		* @brief The files written, removed with the directory
+		*/
+		std::vector<std::string> files;
+};
+
+TEST_CASE("RAPL energy is the sum of the packages since the source was opened")
+{
+	FakePowercap powercap;
+	powercap.addPackage(1000000, 262143328850);
+	powercap.addPackage(5000000, 262143328850);
+
+	RaplPowerSource source(powercap.getRoot());
+	REQUIRE(source.isOpen());
+
+	double joules = -1.0;
+	REQUIRE(source.readEnergy(joules));
+	CHECK_NEAR(joules, 0.0, 1e-9);
+
+	powercap.setEnergy(0, 3000000);
+	powercap.setEnergy(1, 5500000);
+	REQUIRE(source.readEnergy(joules));
+	CHECK_NEAR(joules, 2.5, 1e-9);
+}
+
+TEST_CASE("RAPL counters wrapping around their range keep counting")
+{
+	FakePowercap powercap;
+	powercap.addPackage(4000000, 5000000);
+
+	RaplPowerSource source(powercap.getRoot());
+	double joules = 0.0;
+	powercap.setEnergy(0, 500000);
+	REQUIRE(source.readEnergy(joules));
+	CHECK_NEAR(joules, 1.5, 1e-9);
+}
+
+TEST_CASE("RAPL wrap without a readable range is skipped")
+{
+	FakePowercap powercap;
+	powercap.addPackage(4000000, 0);
+
+	RaplPowerSource source(powercap.getRoot());
+	double joules = 0.0;
+	powercap.setEnergy(0, 500000);
+	REQUIRE(source.readEnergy(joules));
+	CHECK_NEAR(joules, 0.0, 1e-9);
+
+	// The counter starts again from the value read after the wrap
+	powercap.setEnergy(0, 700000);
+	REQUIRE(source.readEnergy(joules));
+	CHECK_NEAR(joules, 0.2, 1e-9);
+}
+
+TEST_CASE("RAPL source without package can not be read")
+{
+	FakePowercap powercap;
+	RaplPowerSource source(powercap.getRoot());
+	double joules = 0.0;
+	CHECK(!source.isOpen());
+	CHECK(!source.readEnergy(joules));
+}
+
+#endif
@@ -0,0 +1,109 @@
+/**
+ * @file ResamplerTests.cpp
+ * @brief Tests of the resampling of the component energies onto the output frames.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "Test.h"
+
+#include "Resampler.h"
+
+#include <vector>
+
+/**
+ * @brief Gets the time at an offset from a fixed origin
+ * @function at
+ * @param {int} ms - The offset in milliseconds
+ * @returns {Resampler::Clock::time_point} the time
+ */
+static Resampler::Clock::time_point at(int ms)
+{
+	return Resampler::Clock::time_point() + std::chrono::milliseconds(ms);
+}
+
+/**
+ * @brief Gets the energy resampled for an application on a component
+ * @function joulesOf
+ * @param {std::vector<Resampler::Output>} outputs - The outputs of a frame
+ * @param {AppId} app - The application
+ * @param {ComponentType} component - The component
+ * @returns {double} the energy, 0 if the application has none
+ */
+static double joulesOf(const std::vector<Resampler::Output>& outputs, AppId app, ComponentType component)
+{
+	for (const Resampler::Output& output : outputs)
+	{
+		if (output.app == app)
+		{
+			return output.joules[static_cast<size_t>(component)];
+		}
+	}
+	return 0;
+}
+
+TEST_CASE("Resampler splits a window between the frames it overlaps")
+{
+	Resampler resampler;
+	AppId app = { 0, 1 };
+
+	// A 300 ms window over frames ending at 100, 200 and 400 ms
+	resampler.add(app, ComponentType::GPU, at(50), at(350), 3.0);
+
+	std::vector<Resampler::Output> outputs;
+	resampler.resample(at(100), outputs);
+	CHECK_NEAR(joulesOf(outputs, app, ComponentType::GPU), 0.5, 1e-9);
+	resampler.resample(at(200), outputs);
+	CHECK_NEAR(joulesOf(outputs, app, ComponentType::GPU), 1.0, 1e-9);
+	resampler.resample(at(400), outputs);
+	CHECK_NEAR(joulesOf(outputs, app, ComponentType::GPU), 1.5, 1e-9);
+
+	resampler.resample(at(500), outputs);
+	CHECK(outputs.empty());
+}
+
+TEST_CASE("Resampler carries the energy reported late into the next frame")
+{
+	Resampler resampler;
+	AppId app = { 0, 1 };
+
+	std::vector<Resampler::Output> outputs;
+	resampler.add(app, ComponentType::CPU, at(0), at(100), 1.0);
+	resampler.resample(at(100), outputs);
+	CHECK_NEAR(joulesOf(outputs, app, ComponentType::CPU), 1.0, 1e-9);
+
+	// A slow sampler reports a window of the frame already published
+	resampler.add(app, ComponentType::NIC, at(0), at(100), 0.25);
+	resampler.add(app, ComponentType::CPU, at(100), at(200), 1.0);
+	resampler.resample(at(200), outputs);
+	CHECK_NEAR(joulesOf(outputs, app, ComponentType::CPU), 1.0, 1e-9);
+	CHECK_NEAR(joulesOf(outputs, app, ComponentType::NIC), 0.25, 1e-9);
+}
+
+TEST_CASE("Resampler keeps the applications and the components apart")
+{
+	Resampler resampler;
+	AppId first = { 0, 1 };
+	AppId reused = { 0, 2 };
+	AppId second = { 1, 1 };
+
+	resampler.add(first, ComponentType::CPU, at(0), at(100), 1.0);
+	resampler.add(first, ComponentType::SD, at(0), at(100), 2.0);
+	resampler.add(reused, ComponentType::CPU, at(0), at(100), 4.0);
+	resampler.add(second, ComponentType::CPU, at(0), at(100), 8.0);
+	resampler.add(first, ComponentType::CPU, at(0), at(100), 16.0);
+
+	// A window starting at the end of the frame belongs to the next one
+	resampler.add(second, ComponentType::CPU, at(100), at(200), 32.0);
+
+	std::vector<Resampler::Output> outputs;
+	resampler.resample(at(100), outputs);
+	CHECK(outputs.size() == 3);
+	CHECK_NEAR(joulesOf(outputs, first, ComponentType::CPU), 17.0, 1e-9);
+	CHECK_NEAR(joulesOf(outputs, first, ComponentType::SD), 2.0, 1e-9);
+	CHECK_NEAR(joulesOf(outputs, reused, ComponentType::CPU), 4.0, 1e-9);
+	CHECK_NEAR(joulesOf(outputs, second, ComponentType::CPU), 8.0, 1e-9);
+
+	resampler.resample(at(200), outputs);
+	CHECK_NEAR(joulesOf(outputs, second, ComponentType::CPU), 32.0, 1e-9);
+}
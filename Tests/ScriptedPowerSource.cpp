@@ -0,0 +1,71 @@
+/**
+ * @file ScriptedPowerSource.cpp
+ * @brief Definition of the power source used by the CPU tests.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "ScriptedPowerSource.h"
+
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+ScriptedPowerSource::ScriptedPowerSource(double joulesPerRead) : joulesPerRead(joulesPerRead)
+{
+}
+
+void ScriptedPowerSource::setFailing(bool failing)
+{
+	this->failing = failing;
+}
+
+std::string ScriptedPowerSource::getName() const
+{
+	return "scripted";
+}
+
+bool ScriptedPowerSource::readEnergy(double& joules)
+{
+	if (failing)
+	{
+		return false;
+	}
+
+	energy += joulesPerRead;
+	joules = energy;
+	return true;
+}
+
+std::chrono::milliseconds ScriptedPowerSource::getCadence() const
+{
+	return std::chrono::milliseconds(0);
+}
+
+int ScriptedPowerSource::getOwnPid()
+{
+#ifdef _WIN32
+	return static_cast<int>(GetCurrentProcessId());
+#else
+	return static_cast<int>(getpid());
+#endif
+}
+
+void ScriptedPowerSource::burnCpu(std::chrono::milliseconds duration)
+{
+	volatile unsigned long long sink = 0;
+	auto end = std::chrono::steady_clock::now() + duration;
+	while (std::chrono::steady_clock::now() < end)
+	{
+		for (int i = 0; i < 10000; i++)
+		{
+			sink = sink + static_cast<unsigned long long>(i);
+		}
+	}
+
+	std::this_thread::sleep_for(duration);
+}
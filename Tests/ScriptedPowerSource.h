@@ -0,0 +1,87 @@
+/**
+ * @file ScriptedPowerSource.h
+ * @brief Implementation of the power source used by the CPU tests.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include "PowerSource.h"
+
+/**
+ * @class ScriptedPowerSource
+ * @brief A power source whose counter grows by a fixed energy at each read, and can be made to fail.
+ *
+ * The CPU sampler reads the real process times of the machine, this source only replaces the energy
+ * counter so the attributed energies are known in advance.
+ */
+class ScriptedPowerSource : public PowerSource
+{
+	public:
+
+		/**
+		* @var {int} UNUSED_PID
+		* @brief A pid no process has, multiple of 4 like the Windows pids
+		*/
+		static constexpr int UNUSED_PID = 0x7ffffffc;
+
+		/**
+		* @brief Builds the source
+		*
+		* @param {double} joulesPerRead - The energy added to the counter before each read
+		*/
+		explicit ScriptedPowerSource(double joulesPerRead);
+
+		/**
+		* @brief Makes the next reads fail or succeed
+		* @function setFailing
+		* @param {bool} failing - true to fail the reads
+		*/
+		void setFailing(bool failing);
+
+		std::string getName() const override;
+		bool readEnergy(double& joules) override;
+		std::chrono::milliseconds getCadence() const override;
+
+		/**
+		* @brief Gets the pid of the tests
+		* @function getOwnPid
+		* @returns {int} the pid
+		*/
+		static int getOwnPid();
+
+		/**
+		* @brief Keeps a core busy so the tests have CPU time to attribute, then leaves it idle as long
+		*
+		* The time of a process and of the system are not read from the same clock off-Windows, a process
+		* using a whole core may then seem to use more than the system and have its energy dropped.
+		*
+		* @function burnCpu
+		* @param {std::chrono::milliseconds} duration - The time to keep the core busy
+		*/
+		static void burnCpu(std::chrono::milliseconds duration);
+
+	private:
+
+		/**
+		* @var {double} joulesPerRead
+		* @brief The energy added before each read
+		*/
+		double joulesPerRead;
+
+		/**
+		* @var {double} energy
+		* @brief The cumulative energy
+		*/
+		double energy = 0.0;
+
+		/**
+		* @var {bool} failing
+		* @brief true while the reads fail
+		*/
+		bool failing = false;
+};
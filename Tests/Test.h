@@ -0,0 +1,140 @@
+/**
+ * @file Test.h
+ * @brief Implementation of the minimal test harness.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @namespace Test
+ * @brief Namespace for the registration and the checks of the test cases.
+ */
+namespace Test
+{
+	/**
+	 * @struct Case
+	 * @brief A test case registered by TEST_CASE
+	 */
+	struct Case
+	{
+		const char* name;
+		void (*run)();
+	};
+
+	/**
+	 * @brief Gets every registered test case
+	 * @function getCases
+	 * @returns {std::vector<Case>&} the test cases, in their registration order
+	 */
+	std::vector<Case>& getCases();
+
+	/**
+	 * @brief Gets every registered benchmark, only run with --bench
+	 * @function getBenchmarks
+	 * @returns {std::vector<Case>&} the benchmarks, in their registration order
+	 */
+	std::vector<Case>& getBenchmarks();
+
+	/**
+	 * @brief Prints the throughput of a measured loop
+	 * @function report
+	 * @param {const char*} label - What was measured
+	 * @param {size_t} operations - The number of operations of the loop
+	 * @param {std::chrono::steady_clock::duration} elapsed - The time the loop took
+	 */
+	void report(const char* label, size_t operations, std::chrono::steady_clock::duration elapsed);
+
+	/**
+	 * @brief Reports a failed check of the running test case
+	 * @function fail
+	 * @param {const char*} file - The file of the check
+	 * @param {int} line - The line of the check
+	 * @param {std::string} message - What was checked
+	 */
+	void fail(const char* file, int line, const std::string& message);
+
+	/**
+	 * @struct Registrar
+	 * @brief Registers a test case when it is built, one per TEST_CASE
+	 */
+	struct Registrar
+	{
+		Registrar(std::vector<Case>& cases, const char* name, void (*run)())
+		{
+			cases.push_back({ name, run });
+		}
+	};
+}
+
+#define TEST_CONCAT_(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT_(a, b)
+
+/**
+ * @def TEST_CASE
+ * @brief Defines a test case, followed by its body
+ */
+#define TEST_CASE(name) \
+	static void TEST_CONCAT(testCase, __LINE__)(); \
+	static Test::Registrar TEST_CONCAT(testRegistrar, __LINE__)(Test::getCases(), name, TEST_CONCAT(testCase, __LINE__)); \
+	static void TEST_CONCAT(testCase, __LINE__)()
+
+/**
+ * @def BENCHMARK
+ * @brief Defines a benchmark, followed by its body which measures its loops and reports them
+ */
+#define BENCHMARK(name) \
+	static void TEST_CONCAT(benchmark, __LINE__)(); \
+	static Test::Registrar TEST_CONCAT(benchmarkRegistrar, __LINE__)(Test::getBenchmarks(), name, TEST_CONCAT(benchmark, __LINE__)); \
+	static void TEST_CONCAT(benchmark, __LINE__)()
+
+/**
+ * @def CHECK
+ * @brief Reports a failure when the condition is false and goes on with the test case
+ */
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			Test::fail(__FILE__, __LINE__, #condition); \
+		} \
+	} while (false)
+
+/**
+ * @def REQUIRE
+ * @brief Reports a failure when the condition is false and leaves the test case
+ */
+#define REQUIRE(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			Test::fail(__FILE__, __LINE__, #condition); \
+			return; \
+		} \
+	} while (false)
+
+/**
+ * @def CHECK_NEAR
+ * @brief Reports a failure when two numbers are further apart than the tolerance
+ */
+#define CHECK_NEAR(actual, expected, tolerance) \
+	do \
+	{ \
+		double actualValue = (actual), expectedValue = (expected); \
+		if (!(std::fabs(actualValue - expectedValue) <= (tolerance))) \
+		{ \
+			std::ostringstream message; \
+			message << #actual << " is " << actualValue << ", expected " << expectedValue; \
+			Test::fail(__FILE__, __LINE__, message.str()); \
+		} \
+	} while (false)
@@ -0,0 +1,102 @@
+/**
+ * @file TimerWheelTests.cpp
+ * @brief Tests of the hierarchical timer wheel.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "Test.h"
+
+#include "TimerWheel.h"
+
+#include <vector>
+
+TEST_CASE("Timer wheel fires the timers in deadline order")
+{
+	TimerWheel wheel(0);
+	wheel.schedule(0, 30);
+	wheel.schedule(1, 10);
+	wheel.schedule(2, 20);
+
+	std::vector<size_t> expired;
+	wheel.advance(15, expired);
+	REQUIRE(expired.size() == 1);
+	CHECK(expired[0] == 1);
+
+	wheel.advance(30, expired);
+	REQUIRE(expired.size() == 3);
+	CHECK(expired[1] == 2 && expired[2] == 0);
+	CHECK(wheel.getNow() == 30);
+
+	uint64_t due = 0;
+	CHECK(!wheel.nextDue(due));
+}
+
+TEST_CASE("Timer wheel cascades the far timers down every level")
+{
+	// One deadline on each level, with offsets that are not on the turns of the levels below
+	const uint64_t deadlines[] = { 5000, 300000, 70, 4096 + 63, 16777000 };
+	TimerWheel wheel(0);
+	for (size_t timer = 0; timer < 5; timer++)
+	{
+		wheel.schedule(timer, deadlines[timer]);
+	}
+
+	std::vector<size_t> expired;
+	const size_t order[] = { 2, 3, 0, 1, 4 };
+	for (size_t i = 0; i < 5; i++)
+	{
+		uint64_t due = 0;
+		REQUIRE(wheel.nextDue(due));
+		CHECK(due == deadlines[order[i]]);
+
+		// A tick short of the deadline fires nothing, the deadline itself fires the timer
+		wheel.advance(due - 1, expired);
+		CHECK(expired.size() == i);
+		wheel.advance(due, expired);
+		REQUIRE(expired.size() == i + 1);
+		CHECK(expired[i] == order[i]);
+	}
+}
+
+TEST_CASE("Timer wheel gives the next deadline across levels")
+{
+	TimerWheel wheel(100);
+
+	// Far deadline placed before a near one on a lower level
+	wheel.schedule(0, 100 + 70000);
+	wheel.schedule(1, 100 + 4000);
+	uint64_t due = 0;
+	REQUIRE(wheel.nextDue(due));
+	CHECK(due == 100 + 4000);
+
+	// The level of the near timer wraps around the current slot
+	wheel.schedule(2, 100 + 63);
+	wheel.schedule(3, 100 + 1);
+	REQUIRE(wheel.nextDue(due));
+	CHECK(due == 101);
+
+	std::vector<size_t> expired;
+	wheel.advance(101, expired);
+	REQUIRE(wheel.nextDue(due));
+	CHECK(due == 163);
+	wheel.advance(4100, expired);
+	REQUIRE(wheel.nextDue(due));
+	CHECK(due == 70100);
+	CHECK(expired.size() == 3);
+}
+
+TEST_CASE("Timer wheel fires a past deadline at the next tick")
+{
+	TimerWheel wheel(1000);
+	wheel.schedule(7, 10);
+
+	uint64_t due = 0;
+	REQUIRE(wheel.nextDue(due));
+	CHECK(due == 1001);
+
+	std::vector<size_t> expired;
+	wheel.advance(1001, expired);
+	REQUIRE(expired.size() == 1);
+	CHECK(expired[0] == 7);
+}
@@ -0,0 +1,86 @@
+/**
+ * @file main.cpp
+ * @brief Runs the test cases.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "Test.h"
+
+#include <cstring>
+#include <iostream>
+
+/**
+ * @var {int} failures
+ * @brief The number of failed checks of the running test case
+ */
+static int failures = 0;
+
+std::vector<Test::Case>& Test::getCases()
+{
+	static std::vector<Case> cases;
+	return cases;
+}
+
+std::vector<Test::Case>& Test::getBenchmarks()
+{
+	static std::vector<Case> benchmarks;
+	return benchmarks;
+}
+
+void Test::report(const char* label, size_t operations, std::chrono::steady_clock::duration elapsed)
+{
+	double seconds = std::chrono::duration<double>(elapsed).count();
+	std::cout << "    " << label << ": " << operations << " operations in " << seconds * 1000 << " ms, "
+		<< seconds * 1e9 / static_cast<double>(operations) << " ns/operation" << std::endl;
+}
+
+void Test::fail(const char* file, int line, const std::string& message)
+{
+	std::cerr << file << "(" << line << "): check failed: " << message << std::endl;
+	failures++;
+}
+
+/**
+ * @brief Runs every test case whose name contains the first argument, or all of them, and the
+ *        benchmarks instead when the first argument is --bench
+ * @returns {int} 0 if every test case passed, 1 otherwise
+ */
+int main(int argc, char* argv[])
+{
+	if (argc > 1 && std::strcmp(argv[1], "--bench") == 0)
+	{
+		const char* filter = argc > 2 ? argv[2] : "";
+		for (const Test::Case& benchmark : Test::getBenchmarks())
+		{
+			if (std::strstr(benchmark.name, filter) != nullptr)
+			{
+				std::cout << benchmark.name << std::endl;
+				benchmark.run();
+			}
+		}
+		return 0;
+	}
+
+	const char* filter = argc > 1 ? argv[1] : "";
+	int failedCases = 0;
+	int ranCases = 0;
+
+	for (const Test::Case& testCase : Test::getCases())
+	{
+		if (std::strstr(testCase.name, filter) == nullptr)
+		{
+			continue;
+		}
+
+		failures = 0;
+		testCase.run();
+		ranCases++;
+
+		std::cout << (failures == 0 ? "[  OK  ] " : "[ FAIL ] ") << testCase.name << std::endl;
+		failedCases += failures == 0 ? 0 : 1;
+	}
+
+	std::cout << ranCases - failedCases << "/" << ranCases << " test cases passed" << std::endl;
+	return failedCases == 0 ? 0 : 1;
+}
@@ -8,60 +8,182 @@
 #include "pch.h"
 
 #include "Wrapper.h"
+#include <msclr/lock.h>
 #include <vector>
 
-extern "C" __declspec(dllexport) bool getIsIntel()
+/**
+ * @class SensorSession
+ * @brief Holds the long-lived bridge shared by every exported function.
+ *
+ * Opening the bridge enumerates every sensor of the machine, so it is done once
+ * and kept until closeSensorSession is called.
+ */
+ref class SensorSession abstract sealed
+{
+    public:
+        /**
+        * @var {ManagedBridge^} bridge
+        * @brief The opened bridge, nullptr while the session is closed
+        */
+        static ManagedBridge^ bridge = nullptr;
+
+        /**
+        * @var {Object^} sync
+        * @brief Serializes the accesses to the bridge
+        */
+        static Object^ sync = gcnew Object();
+
+        /**
+        * @brief Gets the opened bridge, opening it on first use
+        * @function get
+        * @returns {ManagedBridge^} the opened bridge
+        */
+        static ManagedBridge^ get()
+        {
+            if (bridge == nullptr)
+            {
+                bridge = gcnew ManagedBridge();
+            }
+            return bridge;
+        }
+};
+
+extern "C" __declspec(dllexport) bool openSensorSession()
+{
+	msclr::lock lock(SensorSession::sync);
+	try
+	{
+		return SensorSession::get() != nullptr;
+	}
+	catch (Exception^)
+	{
+		return false;
+	}
+}
+
+extern "C" __declspec(dllexport) bool sampleCPUSensors(CPUSensorSample* sample)
+{
+	msclr::lock lock(SensorSession::sync);
+	try
+	{
+		ManagedBridge^ bridge = SensorSession::get();
+		return bridge != nullptr && bridge->Sample(sample);
+	}
+	catch (Exception^)
+	{
+		return false;
+	}
+}
+
+extern "C" __declspec(dllexport) void closeSensorSession()
 {
-	ManagedBridge^ bridge = gcnew ManagedBridge();
-	bool isIntel = bridge->getIsIntel();
-	delete bridge;
+	msclr::lock lock(SensorSession::sync);
+	if (SensorSession::bridge != nullptr)
+	{
+		delete SensorSession::bridge;
+		SensorSession::bridge = nullptr;
+	}
+}
 
-	return isIntel;
+extern "C" __declspec(dllexport) bool getIsIntel()
+{
+	msclr::lock lock(SensorSession::sync);
+	try
+	{
+		ManagedBridge^ bridge = SensorSession::get();
+		return bridge != nullptr && bridge->getIsIntel();
+	}
+	catch (Exception^)
+	{
+		return false;
+	}
 }
 
 extern "C" __declspec(dllexport) float* getCPUCoresPower(int* size)
 {
-	ManagedBridge^ bridge = gcnew ManagedBridge();
-	float^ power = bridge->getCPUCoresPower();
-	delete bridge;
-	
-	*size = 1;
-	float* powerArray = new float[*size];
-	powerArray[0] = *power;
-
-	return powerArray;
+	msclr::lock lock(SensorSession::sync);
+	*size = 0;
+	try
+	{
+		ManagedBridge^ bridge = SensorSession::get();
+		if (bridge == nullptr)
+		{
+			return nullptr;
+		}
+
+		float^ power = bridge->getCPUCoresPower();
+
+		*size = 1;
+		float* powerArray = new float[*size];
+		powerArray[0] = *power;
+
+		return powerArray;
+	}
+	catch (Exception^)
+	{
+		*size = 0;
+		return nullptr;
+	}
 }
 
 extern "C" __declspec(dllexport) float* getCPUCoresClocks(int* size)
 {
-	ManagedBridge^ bridge = gcnew ManagedBridge();
-	List<float>^ clocks = bridge->getCPUCoresClocks();
-	delete bridge;
+	msclr::lock lock(SensorSession::sync);
+	*size = 0;
+	try
+	{
+		ManagedBridge^ bridge = SensorSession::get();
+		if (bridge == nullptr)
+		{
+			return nullptr;
+		}
+
+		List<float>^ clocks = bridge->getCPUCoresClocks();
 
-	*size = clocks->Count;
-	float* clocksArray = new float[*size];
+		*size = clocks->Count;
+		float* clocksArray = new float[*size];
 
-	for (int i = 0; i < *size; i++)
+		for (int i = 0; i < *size; i++)
+		{
+			clocksArray[i] = clocks[i];
+		}
+
+		return clocksArray;
+	}
+	catch (Exception^)
 	{
-		clocksArray[i] = clocks[i];
+		*size = 0;
+		return nullptr;
 	}
-
-	return clocksArray;
 }
 
 extern "C" __declspec(dllexport) float* getCPUCoresVoltages(int* size)
 {
-	ManagedBridge^ bridge = gcnew ManagedBridge();
-	List<float>^ voltages = bridge->getCPUCoresVoltages();
-	delete bridge;
+	msclr::lock lock(SensorSession::sync);
+	*size = 0;
+	try
+	{
+		ManagedBridge^ bridge = SensorSession::get();
+		if (bridge == nullptr)
+		{
+			return nullptr;
+		}
+
+		List<float>^ voltages = bridge->getCPUCoresVoltages();
+
+		*size = voltages->Count;
+		float* voltagesArray = new float[*size];
 
-	*size = voltages->Count;
-	float* voltagesArray = new float[*size];
+		for (int i = 0; i < *size; i++)
+		{
+			voltagesArray[i] = voltages[i];
+		}
 
-	for (int i = 0; i < *size; i++)
+		return voltagesArray;
+	}
+	catch (Exception^)
 	{
-		voltagesArray[i] = voltages[i];
+		*size = 0;
+		return nullptr;
 	}
-
-	return voltagesArray;
-}
\ No newline at end of file
+}
@@ -18,6 +18,27 @@ using namespace System::Collections::Generic;
 using namespace System::Text::RegularExpressions;
 using namespace LibreHardwareMonitor::Hardware;
 
+/**
+ * @def CPU_SENSOR_MAX_CORES
+ * @brief Maximum number of per-core values copied into a CPUSensorSample
+ */
+#define CPU_SENSOR_MAX_CORES 256
+
+/**
+ * @struct CPUSensorSample
+ * @brief Plain buffer filled by one batched read of all CPU sensors.
+ *        Its layout is mirrored by the consumers of Wrapper.dll, keep both in sync.
+ */
+struct CPUSensorSample
+{
+    bool isIntel;
+    float power;
+    int clockCount;
+    int voltageCount;
+    float clocks[CPU_SENSOR_MAX_CORES];
+    float voltages[CPU_SENSOR_MAX_CORES];
+};
+
 /**
  * @class ManagedBridge
  * @brief Links LibreHardwareMonitor library in C# with our c++ application
@@ -46,6 +67,64 @@ public ref class ManagedBridge
             InitializeSensors();
         }
 
+        /**
+        * @brief Destructor for the ManagedBridge class, releases the hardware drivers.
+        */
+        ~ManagedBridge()
+        {
+            computer->Close();
+        }
+
+        /**
+        * @brief Updates the CPU sensors once and copies every value into a plain buffer
+        * @function Sample
+        * @param {CPUSensorSample*} sample - the buffer to fill
+        * @returns {bool} true if the sample was filled, false otherwise
+        */
+        bool Sample(CPUSensorSample* sample)
+        {
+            if (sample == nullptr)
+            {
+                return false;
+            }
+
+            for each (IHardware ^ hardware in cpuHardware)
+            {
+                hardware->Update();
+            }
+
+            sample->isIntel = isIntel;
+            sample->power = 0.0f;
+            sample->clockCount = 0;
+            sample->voltageCount = 0;
+
+            for each (ISensor ^ sensor in powerSensors)
+            {
+                if (sensor->Value.HasValue)
+                {
+                    sample->power = sensor->Value.Value;
+                }
+            }
+
+            for each (ISensor ^ sensor in clockSensors)
+            {
+                if (sensor->Value.HasValue && sample->clockCount < CPU_SENSOR_MAX_CORES)
+                {
+                    sample->clocks[sample->clockCount++] = sensor->Value.Value;
+                }
+            }
+
+            for each (ISensor ^ sensor in voltageSensors)
+            {
+                if (sensor->Value.HasValue && sample->voltageCount < CPU_SENSOR_MAX_CORES)
+                {
+                    sample->voltages[sample->voltageCount++] = sensor->Value.Value;
+                }
+            }
+
+            return true;
+        }
+
         /**
         * @brief Gets the global power of the CPU Cores
         * @function getCPUCoresPower
@@ -133,6 +212,12 @@ public ref class ManagedBridge
         */
         List<ISensor^>^ voltageSensors = gcnew List<ISensor^>();
 
+        /**
+        * @var {List<IHardware^>^} cpuHardware
+        * @brief Contains the CPU hardware to update before reading the sensors
+        */
+        List<IHardware^>^ cpuHardware = gcnew List<IHardware^>();
+
         /**
         * @var {DateTime} lastUpdate
         * @brief Date of the last update
@@ -181,6 +266,7 @@ public ref class ManagedBridge
                 IHardware^ hardware = computer->Hardware[i];
                 if (hardware->HardwareType == HardwareType::Cpu)
                 {
+                    cpuHardware->Add(hardware);
                     String^ identifier = ExtractValueBetweenSlashes(hardware->Identifier->ToString());
                     hardware->Update();
                     if (identifier->Contains("intel", StringComparison::OrdinalIgnoreCase))
@@ -229,7 +315,14 @@ public ref class ManagedBridge
             {
                 lastUpdate = now;
 
+                for each (IHardware ^ hardware in cpuHardware)
+                {
+                    hardware->Update();
+                }
+
                 cpuPower = 0.0f;
+                cpuClocks->Clear();
+                cpuVoltages->Clear();
                 if (isIntel)
                 {
                     for each (ISensor ^ sensor in powerSensors)
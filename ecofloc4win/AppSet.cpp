@@ -0,0 +1,55 @@
+/**
+ * @file AppSet.cpp
+ * @brief Definition of the published list of monitored applications.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "AppSet.h"
+
+#include <atomic>
+
+const MonitoringData* AppSet::Snapshot::find(AppId id) const
+{
+	size_t position;
+	if (!slots.lookup(id, position))
+	{
+		return nullptr;
+	}
+
+	return &apps[position];
+}
+
+AppSet::AppSet() : current(std::make_shared<const Snapshot>())
+{
+}
+
+std::shared_ptr<const AppSet::Snapshot> AppSet::load() const
+{
+#if defined(__cpp_lib_atomic_shared_ptr)
+	return current.load(std::memory_order_acquire);
+#else
+	return std::atomic_load_explicit(&current, std::memory_order_acquire);
+#endif
+}
+
+bool AppSet::update(const Editor& editor)
+{
+	std::lock_guard<std::mutex> lock(writerMutex);
+
+	// Only the writers publish and they are serialized, the snapshot read here stays the current one
+	std::shared_ptr<Snapshot> next = std::make_shared<Snapshot>(*load());
+	if (!editor(*next))
+	{
+		return false;
+	}
+
+	next->version++;
+	std::shared_ptr<const Snapshot> published(std::move(next));
+#if defined(__cpp_lib_atomic_shared_ptr)
+	current.store(std::move(published), std::memory_order_release);
+#else
+	std::atomic_store_explicit(&current, std::move(published), std::memory_order_release);
+#endif
+	return true;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file AppSet.h
+ * @brief Implementation of the published list of monitored applications.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "AppSlots.h"
+#include "MonitoringData.h"
+
+/**
+ * @class AppSet
+ * @brief The monitored applications, published as immutable snapshots.
+ *
+ * The commands never change a published snapshot: they copy it, edit the copy and publish it in one
+ * atomic store. The samplers and the screen load the current snapshot without waiting for the edits
+ * and keep it as long as they need, it is freed once the last of them let it go. The copies of an application share
+ * its counters, so the energies added through an old snapshot are seen through the new one.
+ */
+class AppSet
+{
+	public:
+
+		/**
+		* @struct Snapshot
+		* @brief A version of the monitored list, never changed once published
+		*/
+		struct Snapshot
+		{
+			/**
+			* @var {uint64_t} version
+			* @brief Incremented at each publication, a reader holding the same version has nothing to refresh
+			*/
+			uint64_t version = 0;
+
+			/**
+			* @var {std::vector<MonitoringData>} apps
+			* @brief The applications in the order of the lines of the screen
+			*/
+			std::vector<MonitoringData> apps;
+
+			/**
+			* @var {AppSlots} slots
+			* @brief The position of each application in apps from its identifier
+			*/
+			AppSlots slots;
+
+			/**
+			* @brief Finds an application from its identifier
+			* @function find
+			* @param {AppId} id - The identifier of the application
+			* @returns {const MonitoringData*} the application, nullptr if it is not in this version
+			*/
+			const MonitoringData* find(AppId id) const;
+		};
+
+		/**
+		* @brief Function editing a copy of the current snapshot
+		* @returns {bool} true to publish the copy, false to drop it
+		*/
+		using Editor = std::function<bool(Snapshot&)>;
+
+		AppSet();
+
+		/**
+		* @brief Gets the current snapshot, never waits for an edit in progress
+		* @function load
+		* @returns {std::shared_ptr<const Snapshot>} the snapshot, kept alive as long as it is held
+		*/
+		std::shared_ptr<const Snapshot> load() const;
+
+		/**
+		* @brief Publishes an edited copy of the current snapshot, the edits are serialized
+		* @function update
+		* @param {Editor} editor - Edits the copy and tells if it must be published
+		* @returns {bool} true if a new snapshot was published, false otherwise
+		*/
+		bool update(const Editor& editor);
+
+	private:
+
+		/**
+		* @var {std::atomic<std::shared_ptr<const Snapshot>>} current
+		* @brief The published snapshot, with the atomic shared_ptr functions before C++20 where they are not deprecated yet
+		*/
+#if defined(__cpp_lib_atomic_shared_ptr)
+		std::atomic<std::shared_ptr<const Snapshot>> current;
+#else
+		std::shared_ptr<const Snapshot> current;
+#endif
+
+		/**
+		* @var {std::mutex} writerMutex
+		* @brief Keeps two edits from publishing over each other, the readers never take it
+		*/
+		std::mutex writerMutex;
+};
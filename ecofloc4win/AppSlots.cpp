@@ -0,0 +1,70 @@
+/**
+ * @file AppSlots.cpp
+ * @brief Definition of the stable application identifiers.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "AppSlots.h"
+
+AppId AppSlots::acquire(size_t position)
+{
+	AppId id;
+	if (!freeSlots.empty())
+	{
+		id.slot = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	else
+	{
+		id.slot = static_cast<uint32_t>(slots.size());
+		slots.push_back({ 0, NO_POSITION });
+	}
+
+	id.generation = slots[id.slot].generation;
+	slots[id.slot].position = position;
+	return id;
+}
+
+void AppSlots::release(AppId id)
+{
+	size_t removed;
+	if (!lookup(id, removed))
+	{
+		return;
+	}
+
+	slots[id.slot].generation++;
+	slots[id.slot].position = NO_POSITION;
+	freeSlots.push_back(id.slot);
+
+	for (Slot& slot : slots)
+	{
+		if (slot.position != NO_POSITION && slot.position > removed)
+		{
+			slot.position--;
+		}
+	}
+}
+
+bool AppSlots::lookup(AppId id, size_t& position) const
+{
+	if (id.slot >= slots.size())
+	{
+		return false;
+	}
+
+	const Slot& slot = slots[id.slot];
+	if (slot.generation != id.generation || slot.position == NO_POSITION)
+	{
+		return false;
+	}
+
+	position = slot.position;
+	return true;
+}
+
+size_t AppSlots::capacity() const
+{
+	return slots.size();
+}
@@ -0,0 +1,105 @@
+/**
+ * @file AppSlots.h
+ * @brief Implementation of the stable application identifiers.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct AppId
+ * @brief Stable identifier of a monitored application
+ *
+ * The slot is reused once the application is removed, the generation tells the old identifier
+ * apart from the one of the application now using the slot.
+ */
+struct AppId
+{
+	uint32_t slot = UINT32_MAX;
+	uint32_t generation = 0;
+
+	bool operator==(const AppId& other) const
+	{
+		return slot == other.slot && generation == other.generation;
+	}
+
+	bool operator!=(const AppId& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+/**
+ * @class AppSlots
+ * @brief Slot array giving the position of each application in the monitored list from its identifier.
+ *
+ * The energies are resampled with the identifier of their application and resolved in O(1) against
+ * the current list, even if it was changed in the meantime. It is copied and edited together with the
+ * list it indexes.
+ */
+class AppSlots
+{
+	public:
+
+		/**
+		* @brief Gives an identifier to an application
+		* @function acquire
+		* @param {size_t} position - The position of the application in the list
+		* @returns {AppId} the identifier of the application
+		*/
+		AppId acquire(size_t position);
+
+		/**
+		* @brief Releases the identifier of a removed application, every position after it is shifted back
+		* @function release
+		* @param {AppId} id - The identifier of the removed application
+		*/
+		void release(AppId id);
+
+		/**
+		* @brief Gets the position of an application in the list
+		* @function lookup
+		* @param {AppId} id - The identifier of the application
+		* @param {size_t} position - A reference where the position will be stored
+		* @returns {bool} true if the application is still monitored, false otherwise
+		*/
+		bool lookup(AppId id, size_t& position) const;
+
+		/**
+		* @brief Gets the number of slots, live or free, every slot index is below it
+		* @function capacity
+		* @returns {size_t} the number of slots
+		*/
+		size_t capacity() const;
+
+	private:
+
+		/**
+		* @struct Slot
+		* @brief The generation of a slot and the position of its application, NO_POSITION when free
+		*/
+		struct Slot
+		{
+			uint32_t generation;
+			size_t position;
+		};
+
+		static constexpr size_t NO_POSITION = SIZE_MAX;
+
+		/**
+		* @var {std::vector<Slot>} slots
+		* @brief The slots indexed by AppId::slot
+		*/
+		std::vector<Slot> slots;
+
+		/**
+		* @var {std::vector<uint32_t>} freeSlots
+		* @brief The slots released and ready to be reused
+		*/
+		std::vector<uint32_t> freeSlots;
+};
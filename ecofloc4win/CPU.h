@@ -18,7 +18,81 @@ using json = nlohmann::json;
  * @brief Namespace for CPU-related functionalities.
  */
 namespace CPU
-{	
+{
+	/**
+	 * @var {int} SENSOR_MAX_CORES
+	 * @brief Maximum number of per-core values in a SensorSample, must match Wrapper.dll
+	 */
+	constexpr int SENSOR_MAX_CORES = 256;
+
+	/**
+	 * @struct SensorSample
+	 * @brief Mirror of the CPUSensorSample buffer filled by Wrapper.dll
+	 */
+	struct SensorSample
+	{
+		bool isIntel;
+		float power;
+		int clockCount;
+		int voltageCount;
+		float clocks[SENSOR_MAX_CORES];
+		float voltages[SENSOR_MAX_CORES];
+	};
+
+	/**
+	 * @class SensorBackend
+	 * @brief Loads Wrapper.dll once and keeps its resolved entry points.
+	 *
+	 * The library is loaded and the sensor session opened the first time the instance is used,
+	 * a failure is reported once and every later call simply returns false.
+	 */
+	class SensorBackend
+	{
+		public:
+			/**
+			 * @brief Gets the shared backend, loading Wrapper.dll on first use
+			 * @function getInstance
+			 * @returns {SensorBackend&} the shared backend
+			 */
+			static SensorBackend& getInstance();
+
+			/**
+			 * @brief Returns if Wrapper.dll and all its entry points were loaded
+			 * @function isAvailable
+			 * @returns {bool} true if the backend can be sampled, false otherwise
+			 */
+			bool isAvailable() const;
+
+			/**
+			 * @brief Reads every CPU sensor in one call
+			 * @function sample
+			 * @param {SensorSample} sample - A reference to the buffer to fill
+			 * @returns {bool} True if the sample was filled, false otherwise
+			 */
+			bool sample(SensorSample& sample);
+
+			SensorBackend(const SensorBackend&) = delete;
+			SensorBackend& operator=(const SensorBackend&) = delete;
+
+		private:
+			SensorBackend();
+			~SensorBackend();
+
+			typedef bool (*open_sensor_session_func)();
+			typedef bool (*sample_cpu_sensors_func)(SensorSample* sample);
+			typedef void (*close_sensor_session_func)();
+
+			/**
+			 * @var {HMODULE} module
+			 * @brief Handle of Wrapper.dll, nullptr if it could not be loaded
+			 */
+			HMODULE module = nullptr;
+
+			open_sensor_session_func openSession = nullptr;
+			sample_cpu_sensors_func sampleSensors = nullptr;
+			close_sensor_session_func closeSession = nullptr;
+	};
+
 	/**
 	* @brief Retrieves the capacitance of the CPU.
     * @function getCapacitance
@@ -42,33 +116,10 @@ namespace CPU
     */
 	bool getAvgVolt(double& volt);
 
-	/**
-     * @brief Converts a FILETIME structure to a uint64_t.
-     *
-     * @param {FILETIME} ft - The FILETIME structure to convert.
-     * @returns {uint64_t} The converted value.
-     */
-	uint64_t fromFileTime(const FILETIME& ft);
-
-	/**
-     * @brief Retrieves the total CPU time including idle, kernel, and user times.
-     *
-     * @returns {uint64_t} The total CPU time in 100-nanosecond intervals. Returns -1 on failure.
-     */
-	uint64_t getCPUTime();
-
-	/**
-     * @brief Retrieves the total time spent by a process.
-     *
-     * @param {DWORD} pid - The process ID of the target process.
-     * @returns {uint64_t} The total process time (kernel + user) in 100-nanosecond intervals. Returns -1 on failure.
-     */
-	uint64_t getPidTime(DWORD pid);
-
 	/**
      * @brief Retrieves the current power consumption of the CPU.
      *
-     * This function uses a DLL (`Wrapper.dll`) to retrieve the power consumption of CPU cores.
+     * This function uses the shared SensorBackend (`Wrapper.dll`) to retrieve the power consumption of CPU cores.
      *
      * @param {double} power - A reference to a double where the calculated power will be stored.
      * @return {bool} True if the power was successfully retrieved, false otherwise.
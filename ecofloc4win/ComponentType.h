@@ -0,0 +1,29 @@
+/**
+ * @file ComponentType.h
+ * @brief Implementation of the measured components.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @enum ComponentType
+ * @brief The hardware components whose energy is attributed to the applications, usable as an index
+ */
+enum class ComponentType : uint8_t
+{
+	CPU,
+	GPU,
+	SD,
+	NIC
+};
+
+/**
+ * @var {size_t} COMPONENT_COUNT
+ * @brief The number of components
+ */
+constexpr size_t COMPONENT_COUNT = 4;
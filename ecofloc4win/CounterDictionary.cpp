@@ -0,0 +1,240 @@
+/**
+ * @file CounterDictionary.cpp
+ * @brief Definition of the performance counters dictionary.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "CounterDictionary.h"
+#include "Utils.h"
+
+#include <Pdh.h>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include "json.hpp"
+using json = nlohmann::json;
+
+/**
+ * @var {const char*} CACHE_PATH
+ * @brief The file where the indices are kept between two runs
+ */
+static const char* CACHE_PATH = "../Config/pdh_counters.json";
+
+/**
+ * @brief Reads the build of the OS from the registry
+ * @function readOsBuild
+ * @returns {std::string} the build and its revision (e.g. 19045.5371), empty on failure
+ */
+static std::string readOsBuild()
+{
+	HKEY hKey;
+	if (RegOpenKeyEx(HKEY_LOCAL_MACHINE, L"SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion", 0, KEY_READ, &hKey) != ERROR_SUCCESS)
+	{
+		return "";
+	}
+
+	wchar_t build[64] = L"";
+	DWORD buildSize = sizeof(build);
+	DWORD revision = 0;
+	DWORD revisionSize = sizeof(revision);
+
+	bool found = RegQueryValueEx(hKey, L"CurrentBuildNumber", NULL, NULL, reinterpret_cast<LPBYTE>(build), &buildSize) == ERROR_SUCCESS;
+	RegQueryValueEx(hKey, L"UBR", NULL, NULL, reinterpret_cast<LPBYTE>(&revision), &revisionSize);
+	RegCloseKey(hKey);
+
+	if (!found)
+	{
+		return "";
+	}
+
+	return Utils::wstringToString(build) + "." + std::to_string(revision);
+}
+
+CounterDictionary& CounterDictionary::getInstance()
+{
+	static CounterDictionary instance;
+	return instance;
+}
+
+CounterDictionary::CounterDictionary()
+{
+	osBuild = readOsBuild();
+
+	if (loadFromCache())
+	{
+		return;
+	}
+
+	if (loadFromRegistry())
+	{
+		saveToCache();
+	}
+}
+
+bool CounterDictionary::loadFromRegistry()
+{
+	HKEY hKey;
+	if (RegOpenKeyEx(HKEY_LOCAL_MACHINE, L"SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion\\Perflib\\009", 0, KEY_READ, &hKey) != ERROR_SUCCESS)
+	{
+		std::cerr << "Failed to open registry key" << std::endl;
+		return false;
+	}
+
+	DWORD dataSize = 0;
+	if (RegQueryValueEx(hKey, L"Counter", NULL, NULL, NULL, &dataSize) != ERROR_SUCCESS)
+	{
+		std::cerr << "Failed to query registry value size" << std::endl;
+		RegCloseKey(hKey);
+		return false;
+	}
+
+	// Allocate buffer for the Counter data
+	std::unique_ptr<char[]> buffer(new char[dataSize]);
+	if (RegQueryValueEx(hKey, L"Counter", NULL, NULL, reinterpret_cast<LPBYTE>(buffer.get()), &dataSize) != ERROR_SUCCESS)
+	{
+		std::cerr << "Failed to query registry value" << std::endl;
+		RegCloseKey(hKey);
+		return false;
+	}
+
+	RegCloseKey(hKey);
+
+	// Parse the buffer, it alternates indices and names
+	std::string temp;
+	std::string currentIndex;
+	bool isIndex = true; // Tracks if the current string is an index or a name
+
+	for (DWORD i = 0; i < dataSize; i += 2)  // Increment by 2 to skip null terminators
+	{
+		if (buffer[i] == '\0')
+		{
+			// Process accumulated string
+			if (!temp.empty())
+			{
+				if (isIndex)
+				{
+					currentIndex = temp;  // Save the index
+				}
+				else
+				{
+					// Keep the first index when a name is registered several times
+					indices.emplace(temp, std::stoul(currentIndex));
+				}
+
+				temp.clear();          // Reset for the next string
+				isIndex = !isIndex;    // Toggle between index and name
+			}
+		}
+		else
+		{
+			temp += buffer[i];  // Append meaningful character (skip '\0')
+		}
+	}
+
+	return true;
+}
+
+bool CounterDictionary::loadFromCache()
+{
+	if (osBuild.empty())
+	{
+		return false;
+	}
+
+	try
+	{
+		std::ifstream f(CACHE_PATH);
+		if (!f.is_open())
+		{
+			return false;
+		}
+
+		json cache = json::parse(f);
+		if (cache["build"] != osBuild)
+		{
+			return false;
+		}
+
+		indices = cache["counters"].get<std::unordered_map<std::string, DWORD>>();
+		return !indices.empty();
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Ignoring counter cache " << CACHE_PATH << ": " << e.what() << std::endl;
+		indices.clear();
+		return false;
+	}
+}
+
+void CounterDictionary::saveToCache() const
+{
+	if (osBuild.empty())
+	{
+		return;
+	}
+
+	std::ofstream f(CACHE_PATH);
+	if (!f.is_open())
+	{
+		// The cache is optional, the dictionary will be parsed again on the next run
+		return;
+	}
+
+	json cache;
+	cache["build"] = osBuild;
+	cache["counters"] = indices;
+	f << cache.dump();
+}
+
+DWORD CounterDictionary::getIndex(const std::string& counterName) const
+{
+	auto it = indices.find(counterName);
+	if (it == indices.end())
+	{
+		return -1;
+	}
+
+	return it->second;
+}
+
+std::wstring CounterDictionary::getLocalizedName(const std::string& counterName)
+{
+	std::lock_guard<std::mutex> lock(localizedMutex);
+
+	auto it = localizedNames.find(counterName);
+	if (it != localizedNames.end())
+	{
+		return it->second;
+	}
+
+	DWORD index = getIndex(counterName);
+	if (index == (DWORD)-1)
+	{
+		std::cerr << "Unknown counter: " << counterName << std::endl;
+		return L"";
+	}
+
+	wchar_t localizedName[PDH_MAX_COUNTER_PATH];
+	DWORD size = PDH_MAX_COUNTER_PATH;
+	if (PdhLookupPerfNameByIndex(NULL, index, localizedName, &size) != ERROR_SUCCESS)
+	{
+		std::cerr << "Failed to get localized counter path" << std::endl;
+		return L"";
+	}
+
+	return localizedNames.emplace(counterName, localizedName).first->second;
+}
+
+std::wstring CounterDictionary::getProcessCounterPath(const std::wstring& instanceName, const std::string& counterName)
+{
+	std::wstring localizedProcessName = getLocalizedName("Process");
+	std::wstring localizedName = getLocalizedName(counterName);
+
+	if (localizedProcessName.empty() || localizedName.empty())
+	{
+		return L"";
+	}
+
+	return L"\\" + localizedProcessName + L"(" + instanceName + L")\\" + localizedName;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file CounterDictionary.h
+ * @brief Implementation of the performance counters dictionary.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <windows.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @class CounterDictionary
+ * @brief Resolves the english names of the performance counters to their index and localized path.
+ *
+ * The Perflib registry multi-string is parsed once into a hash map, optionally loaded from and saved to
+ * a small cache file keyed by the OS build, so resolving a counter path afterwards is a lookup.
+ */
+class CounterDictionary
+{
+	public:
+
+		/**
+		* @brief Gets the shared dictionary, building it on first use
+		* @function getInstance
+		* @returns {CounterDictionary&} the shared dictionary
+		*/
+		static CounterDictionary& getInstance();
+
+		/**
+		* @brief Gets the index of a counter based on its english name
+		* @function getIndex
+		* @param {std::string} counterName - The english name of the counter
+		* @returns {DWORD} the index of the counter, -1 if it is unknown
+		*/
+		DWORD getIndex(const std::string& counterName) const;
+
+		/**
+		* @brief Gets the localized name of a counter based on its english name
+		* @function getLocalizedName
+		* @param {std::string} counterName - The english name of the counter
+		* @returns {std::wstring} the localized name, empty if it is unknown
+		*/
+		std::wstring getLocalizedName(const std::string& counterName);
+
+		/**
+		* @brief Gets the localized path of a counter of the Process object
+		* @function getProcessCounterPath
+		* @param {std::wstring} instanceName - The name of the process instance, or * for all of them
+		* @param {std::string} counterName - The english name of the counter
+		* @returns {std::wstring} the localized counter path, empty if it could not be resolved
+		*/
+		std::wstring getProcessCounterPath(const std::wstring& instanceName, const std::string& counterName);
+
+		CounterDictionary(const CounterDictionary&) = delete;
+		CounterDictionary& operator=(const CounterDictionary&) = delete;
+
+	private:
+		CounterDictionary();
+
+		/**
+		* @brief Parses the Perflib registry multi-string into indices
+		* @returns {bool} true if the registry could be read, false otherwise
+		*/
+		bool loadFromRegistry();
+
+		/**
+		* @brief Loads the indices from the cache file if it was written on the same OS build
+		* @returns {bool} true if the cache was loaded, false otherwise
+		*/
+		bool loadFromCache();
+
+		/**
+		* @brief Writes the indices to the cache file
+		*/
+		void saveToCache() const;
+
+		/**
+		* @var {std::string} osBuild
+		* @brief The build of the OS, used as the key of the cache file
+		*/
+		std::string osBuild;
+
+		/**
+		* @var {std::unordered_map<std::string, DWORD>} indices
+		* @brief The index of each english counter name
+		*/
+		std::unordered_map<std::string, DWORD> indices;
+
+		/**
+		* @var {std::unordered_map<std::string, std::wstring>} localizedNames
+		* @brief The localized names already looked up
+		*/
+		std::unordered_map<std::string, std::wstring> localizedNames;
+
+		/**
+		* @var {std::mutex} localizedMutex
+		* @brief Protects localizedNames, the samplers resolve paths from several threads
+		*/
+		std::mutex localizedMutex;
+};
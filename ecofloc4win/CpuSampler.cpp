@@ -0,0 +1,125 @@
+/**
+ * @file CpuSampler.cpp
+ * @brief Definition of the CPU energy attribution.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "CpuSampler.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+CpuSampler::CpuSampler(std::unique_ptr<PowerSource> powerSource) : powerSource(std::move(powerSource)), appPidOffsets(1, 0)
+{
+}
+
+PowerSource& CpuSampler::getPowerSource() const
+{
+	return *powerSource;
+}
+
+void CpuSampler::clearApps()
+{
+	appIds.clear();
+	pids.clear();
+	appPidOffsets.assign(1, 0);
+}
+
+void CpuSampler::addApp(AppId id, const std::vector<int>& appPids)
+{
+	appIds.push_back(id);
+	pids.insert(pids.end(), appPids.begin(), appPids.end());
+	appPidOffsets.push_back(pids.size());
+}
+
+bool CpuSampler::sample()
+{
+	if (appIds.empty())
+	{
+		primed = false;
+		return false;
+	}
+
+	// The end of the previous interval is the start of this one, the first call only reads it
+	double startEnergy = lastEnergy;
+	double endEnergy = 0.0;
+	std::swap(startTimes, endTimes);
+
+	if (!powerSource->readEnergy(endEnergy) || !endTimes.capture(pids))
+	{
+		std::cerr << "Failed to read energy from " << powerSource->getName() << std::endl;
+		primed = false;
+		return false;
+	}
+
+	lastEnergy = endEnergy;
+	if (!primed)
+	{
+		primed = true;
+		return false;
+	}
+
+	double intervalEnergy = endEnergy - startEnergy;
+	double cpuTimeDiff = static_cast<double>(endTimes.getSystemTime()) - static_cast<double>(startTimes.getSystemTime());
+	if (cpuTimeDiff <= 0)
+	{
+		return false;
+	}
+
+	// Attribute the energy of the interval to every pid in a single pass, pids that were not
+	// running during the whole interval are left at zero
+	pidEnergies.assign(pids.size(), 0.0);
+	for (size_t i = 0; i < pids.size(); i++)
+	{
+		uint64_t startPidTime = 0, endPidTime = 0;
+		if (!startTimes.getTime(pids[i], startPidTime) || !endTimes.getTime(pids[i], endPidTime))
+		{
+			continue;
+		}
+
+		double pidTimeDiff = static_cast<double>(endPidTime) - static_cast<double>(startPidTime);
+		pidEnergies[i] = intervalEnergy * (pidTimeDiff / cpuTimeDiff);
+	}
+
+	// Sum the pids of each application
+	appEnergies.assign(appIds.size(), 0.0);
+	for (size_t i = 0; i < appIds.size(); i++)
+	{
+		for (size_t j = appPidOffsets[i]; j < appPidOffsets[i + 1]; j++)
+		{
+			appEnergies[i] += pidEnergies[j];
+		}
+
+		// Validate time differences
+		if (appEnergies[i] > intervalEnergy)
+		{
+			std::cerr << "Error: Process time is greater than CPU time." << std::endl;
+			appEnergies[i] = 0.0;
+			std::fill(pidEnergies.begin() + appPidOffsets[i], pidEnergies.begin() + appPidOffsets[i + 1], 0.0);
+		}
+	}
+
+	return true;
+}
+
+size_t CpuSampler::getAppCount() const
+{
+	return appIds.size();
+}
+
+AppId CpuSampler::getAppId(size_t app) const
+{
+	return appIds[app];
+}
+
+double CpuSampler::getAppEnergy(size_t app) const
+{
+	return appEnergies[app];
+}
+
+const double* CpuSampler::getPidEnergies(size_t app) const
+{
+	return pidEnergies.data() + appPidOffsets[app];
+}
@@ -0,0 +1,160 @@
+/**
+ * @file CpuSampler.h
+ * @brief Implementation of the CPU energy attribution.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "AppSlots.h"
+#include "PowerSource.h"
+#include "ProcessTimes.h"
+
+/**
+ * @class CpuSampler
+ * @brief Splits the energy read from a power source between applications by the CPU time of their pids.
+ *
+ * Each call to sample reads the cumulative energy of the source and captures the times of every pid in
+ * one ProcessTimes snapshot, then gives each pid the part of the energy used since the previous call
+ * that its time is of the time of the whole system. The pids of an application are stored one after
+ * the other so their energies are summed in one pass. Nothing depends on Windows, the same core runs
+ * on the RAPL source off-Windows.
+ */
+class CpuSampler
+{
+	public:
+
+		/**
+		* @brief Builds a sampler without application
+		*
+		* @param {std::unique_ptr<PowerSource>} powerSource - The source of the energy, never null
+		*/
+		explicit CpuSampler(std::unique_ptr<PowerSource> powerSource);
+
+		/**
+		* @brief Gets the source of the energy
+		* @function getPowerSource
+		* @returns {PowerSource&} the source
+		*/
+		PowerSource& getPowerSource() const;
+
+		/**
+		* @brief Forgets the applications, the energy read last stays the start of the next interval
+		* @function clearApps
+		*/
+		void clearApps();
+
+		/**
+		* @brief Adds an application to measure
+		* @function addApp
+		* @param {AppId} id - The application
+		* @param {std::vector<int>} pids - The pids of the application
+		*/
+		void addApp(AppId id, const std::vector<int>& pids);
+
+		/**
+		* @brief Reads the energy and the times, and attributes the energy used since the previous call
+		* @function sample
+		* @returns {bool} true if the energies of an interval were computed, false on the first call, after
+		*          a failed read or without application
+		*/
+		bool sample();
+
+		/**
+		* @brief Gets the number of applications
+		* @function getAppCount
+		* @returns {size_t} the number of applications added since the last clearApps
+		*/
+		size_t getAppCount() const;
+
+		/**
+		* @brief Gets the identifier of an application
+		* @function getAppId
+		* @param {size_t} app - The position of the application, in the order they were added
+		* @returns {AppId} the identifier
+		*/
+		AppId getAppId(size_t app) const;
+
+		/**
+		* @brief Gets the energy used by an application during the last interval
+		* @function getAppEnergy
+		* @param {size_t} app - The position of the application
+		* @returns {double} the energy in Joules, the sum of its pids
+		*/
+		double getAppEnergy(size_t app) const;
+
+		/**
+		* @brief Gets the energy used by each pid of an application during the last interval
+		* @function getPidEnergies
+		* @param {size_t} app - The position of the application
+		* @returns {const double*} the energy in Joules of each pid, in the order they were added
+		*/
+		const double* getPidEnergies(size_t app) const;
+
+	private:
+
+		/**
+		* @var {std::unique_ptr<PowerSource>} powerSource
+		* @brief The source of the energy
+		*/
+		std::unique_ptr<PowerSource> powerSource;
+
+		/**
+		* @var {bool} primed
+		* @brief true once the start of the next interval was read
+		*/
+		bool primed = false;
+
+		/**
+		* @var {double} lastEnergy
+		* @brief The cumulative energy read at the start of the next interval
+		*/
+		double lastEnergy = 0.0;
+
+		/**
+		* @var {ProcessTimes} startTimes
+		* @brief The times at the start of the last interval
+		*/
+		ProcessTimes startTimes;
+
+		/**
+		* @var {ProcessTimes} endTimes
+		* @brief The times at the end of the last interval, the start of the next one
+		*/
+		ProcessTimes endTimes;
+
+		/**
+		* @var {std::vector<AppId>} appIds
+		* @brief The identifier of each application
+		*/
+		std::vector<AppId> appIds;
+
+		/**
+		* @var {std::vector<size_t>} appPidOffsets
+		* @brief The pids of the application i are stored in pids between appPidOffsets[i] and appPidOffsets[i + 1]
+		*/
+		std::vector<size_t> appPidOffsets;
+
+		/**
+		* @var {std::vector<int>} pids
+		* @brief The pids of every application
+		*/
+		std::vector<int> pids;
+
+		/**
+		* @var {std::vector<double>} pidEnergies
+		* @brief The energy of each pid during the last interval, in the order of pids
+		*/
+		std::vector<double> pidEnergies;
+
+		/**
+		* @var {std::vector<double>} appEnergies
+		* @brief The energy of each application during the last interval
+		*/
+		std::vector<double> appEnergies;
+};
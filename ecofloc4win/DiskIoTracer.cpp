@@ -0,0 +1,319 @@
+/**
+ * @file DiskIoTracer.cpp
+ * @brief Definition of the event-driven disk I/O accounting.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "DiskIoTracer.h"
+
+#include <cstring>
+#include <iostream>
+
+DiskIoTracer::DiskIoTracer() : counters(RELEASE_DELAY), irps(IRP_CAPACITY, IRP_TIMEOUT)
+{
+}
+
+DiskIoTracer::~DiskIoTracer()
+{
+	stop();
+}
+
+void DiskIoTracer::onEvent(const Event& event)
+{
+	counters.releaseEnded(event.timestamp);
+
+	switch (event.type)
+	{
+	case EventType::ProcessStart:
+		// The pid may be reused, what is left belongs to the previous process
+		counters.track(event.pid);
+		break;
+
+	case EventType::ProcessEnd:
+		// The slot is kept a while for the completions still in flight and the last take of the sampler
+		counters.end(event.pid, event.timestamp);
+		break;
+
+	case EventType::ReadInit:
+	case EventType::WriteInit:
+	{
+		// Idle and the requests of unknown processes can not be attributed
+		if (event.pid == 0 || event.pid == UINT32_MAX)
+		{
+			break;
+		}
+
+		IrpTable::Entry irp = {};
+		irp.irp = event.irp;
+		irp.issuedAt = event.timestamp;
+		irp.pid = event.pid;
+		irp.operationType = static_cast<uint16_t>(event.type);
+
+		if (!irps.insert(irp))
+		{
+			droppedEvents.fetch_add(1, std::memory_order_relaxed);
+		}
+		break;
+	}
+
+	case EventType::ReadComplete:
+	case EventType::WriteComplete:
+	{
+		// Requests initiated before the trace started, or evicted, have no entry
+		IrpTable::Entry irp;
+		if (!irps.take(event.irp, irp))
+		{
+			break;
+		}
+
+		irp.bytesTransferred += event.size;
+		if (!counters.add(irp.pid, event.type == EventType::ReadComplete ? 0 : 1, irp.bytesTransferred))
+		{
+			droppedEvents.fetch_add(1, std::memory_order_relaxed);
+		}
+		break;
+	}
+	}
+}
+
+void DiskIoTracer::replay(const std::vector<Event>& events)
+{
+	for (const Event& event : events)
+	{
+		onEvent(event);
+	}
+}
+
+bool DiskIoTracer::takeBytes(int pid, uint64_t& readBytes, uint64_t& writeBytes)
+{
+	return counters.take(static_cast<uint32_t>(pid), readBytes, writeBytes);
+}
+
+uint64_t DiskIoTracer::getDroppedEvents() const
+{
+	return droppedEvents.load(std::memory_order_relaxed);
+}
+
+size_t DiskIoTracer::getTrackedProcesses() const
+{
+	return counters.getTrackedProcesses();
+}
+
+#ifdef _WIN32
+
+/**
+ * @brief Defines the kernel trace identifiers and DiskIo opcodes used here
+ * @{
+ */
+static const wchar_t* SESSION_NAME = L"Ecofloc Disk Trace";
+static const GUID DISK_IO_GUID = { 0x3d6fa8d4, 0xfe05, 0x11d0, { 0x9d, 0xda, 0x00, 0xc0, 0x4f, 0xd7, 0xba, 0x7c } };
+static const GUID PROCESS_GUID = { 0x3d6fa8d0, 0xfe05, 0x11d0, { 0x9d, 0xda, 0x00, 0xc0, 0x4f, 0xd7, 0xba, 0x7c } };
+
+#define DISK_IO_OPCODE_READ 10
+#define DISK_IO_OPCODE_WRITE 11
+#define DISK_IO_OPCODE_READ_INIT 12
+#define DISK_IO_OPCODE_WRITE_INIT 13
+#define PROCESS_OPCODE_START 1
+#define PROCESS_OPCODE_END 2
+#define PROCESS_OPCODE_DC_START 3
+/**
+ * @}
+ */
+
+/**
+ * @brief Reads a pointer-sized field of an event payload
+ * @function readPointer
+ * @param {const BYTE*} data - The start of the field
+ * @param {size_t} pointerSize - The size of a pointer on the machine that logged the event
+ * @returns {uint64_t} the value of the field
+ */
+static uint64_t readPointer(const BYTE* data, size_t pointerSize)
+{
+	if (pointerSize == 4)
+	{
+		uint32_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	uint64_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+/**
+ * @brief Decodes a process start or end event, running processes are listed by DCStart when the session starts
+ * @function decodeProcess
+ * @param {PEVENT_RECORD} record - The Process event
+ * @param {size_t} pointerSize - The size of a pointer on the machine that logged the event
+ * @param {DiskIoTracer::Event} event - A reference where the decoded event will be stored
+ * @returns {bool} true if the payload could be decoded, false otherwise
+ */
+static bool decodeProcess(PEVENT_RECORD record, size_t pointerSize, DiskIoTracer::Event& event)
+{
+	const BYTE* data = static_cast<const BYTE*>(record->UserData);
+	size_t length = record->UserDataLength;
+
+	// UniqueProcessKey, ProcessId, ParentId, SessionId, ExitStatus, ..., only the pid is used
+	size_t offset = pointerSize;
+	if (length < offset + 16 + pointerSize)
+	{
+		return false;
+	}
+	std::memcpy(&event.pid, data + offset, sizeof(event.pid));
+
+	event.type = record->EventHeader.EventDescriptor.Opcode == PROCESS_OPCODE_END ? DiskIoTracer::EventType::ProcessEnd : DiskIoTracer::EventType::ProcessStart;
+	return true;
+}
+
+void WINAPI DiskIoTracer::onEventRecord(PEVENT_RECORD record)
+{
+	DiskIoTracer* tracer = static_cast<DiskIoTracer*>(record->UserContext);
+	const BYTE* data = static_cast<const BYTE*>(record->UserData);
+	size_t pointerSize = (record->EventHeader.Flags & EVENT_HEADER_FLAG_32_BIT_HEADER) ? 4 : 8;
+	Event event = {};
+	event.timestamp = static_cast<uint64_t>(record->EventHeader.TimeStamp.QuadPart);
+
+	if (IsEqualGUID(record->EventHeader.ProviderId, PROCESS_GUID))
+	{
+		UCHAR opcode = record->EventHeader.EventDescriptor.Opcode;
+		// DCEnd lists the processes still running when the session stops, they did not end
+		if ((opcode == PROCESS_OPCODE_START || opcode == PROCESS_OPCODE_DC_START || opcode == PROCESS_OPCODE_END) && decodeProcess(record, pointerSize, event))
+		{
+			tracer->onEvent(event);
+		}
+		return;
+	}
+
+	if (!IsEqualGUID(record->EventHeader.ProviderId, DISK_IO_GUID))
+	{
+		return;
+	}
+
+	switch (record->EventHeader.EventDescriptor.Opcode)
+	{
+	case DISK_IO_OPCODE_READ_INIT:
+	case DISK_IO_OPCODE_WRITE_INIT:
+		// Irp, IssuingThreadId: the init is logged in the context of the issuing process
+		if (record->UserDataLength < pointerSize)
+		{
+			return;
+		}
+		event.type = record->EventHeader.EventDescriptor.Opcode == DISK_IO_OPCODE_READ_INIT ? EventType::ReadInit : EventType::WriteInit;
+		event.irp = readPointer(data, pointerSize);
+		event.pid = record->EventHeader.ProcessId;
+		break;
+
+	case DISK_IO_OPCODE_READ:
+	case DISK_IO_OPCODE_WRITE:
+		// DiskNumber, IrpFlags, TransferSize, Reserved, ByteOffset, FileObject, Irp, ...
+		if (record->UserDataLength < 24 + 2 * pointerSize)
+		{
+			return;
+		}
+		event.type = record->EventHeader.EventDescriptor.Opcode == DISK_IO_OPCODE_READ ? EventType::ReadComplete : EventType::WriteComplete;
+		std::memcpy(&event.size, data + 8, sizeof(event.size));
+		event.irp = readPointer(data + 24 + pointerSize, pointerSize);
+		break;
+
+	default:
+		return;
+	}
+
+	tracer->onEvent(event);
+}
+
+bool DiskIoTracer::start()
+{
+	if (consumer.joinable())
+	{
+		return true;
+	}
+
+	// A private system logger (Windows 8 and later) receives the kernel events without taking the
+	// "NT Kernel Logger" session away from the other tools using it
+	size_t nameSize = (wcslen(SESSION_NAME) + 1) * sizeof(wchar_t);
+	properties.assign(sizeof(EVENT_TRACE_PROPERTIES) + nameSize, 0);
+	EVENT_TRACE_PROPERTIES* props = reinterpret_cast<EVENT_TRACE_PROPERTIES*>(properties.data());
+	props->Wnode.BufferSize = static_cast<ULONG>(properties.size());
+	props->Wnode.ClientContext = 2; // System time timestamps, in 100ns units
+	props->Wnode.Flags = WNODE_FLAG_TRACED_GUID;
+	props->EnableFlags = EVENT_TRACE_FLAG_PROCESS | EVENT_TRACE_FLAG_DISK_IO | EVENT_TRACE_FLAG_DISK_IO_INIT;
+	props->LogFileMode = EVENT_TRACE_REAL_TIME_MODE | EVENT_TRACE_SYSTEM_LOGGER_MODE;
+	props->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+
+	ULONG status = StartTrace(&sessionHandle, SESSION_NAME, props);
+	if (status == ERROR_ALREADY_EXISTS)
+	{
+		// Take the session over from a previous run that did not stop it
+		ControlTrace(0, SESSION_NAME, props, EVENT_TRACE_CONTROL_STOP);
+		props->Wnode.BufferSize = static_cast<ULONG>(properties.size());
+		props->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+		status = StartTrace(&sessionHandle, SESSION_NAME, props);
+	}
+
+	// Without the session, for example when every system logger is taken, the sampler uses the PDH rates
+	if (status != ERROR_SUCCESS)
+	{
+		std::cerr << "Failed to start the disk I/O trace session. Error: " << status << std::endl;
+		sessionHandle = 0;
+		return false;
+	}
+
+	EVENT_TRACE_LOGFILE logFile = {};
+	logFile.LoggerName = const_cast<LPWSTR>(SESSION_NAME);
+	logFile.ProcessTraceMode = PROCESS_TRACE_MODE_REAL_TIME | PROCESS_TRACE_MODE_EVENT_RECORD;
+	logFile.EventRecordCallback = onEventRecord;
+	logFile.Context = this;
+
+	traceHandle = OpenTrace(&logFile);
+	if (traceHandle == INVALID_PROCESSTRACE_HANDLE)
+	{
+		std::cerr << "Failed to open the disk I/O trace. Error: " << GetLastError() << std::endl;
+		stop();
+		return false;
+	}
+
+	consumer = std::thread([this]
+	{
+		// Blocks until the session is stopped
+		ProcessTrace(&traceHandle, 1, nullptr, nullptr);
+	});
+
+	return true;
+}
+
+void DiskIoTracer::stop()
+{
+	if (sessionHandle != 0)
+	{
+		EVENT_TRACE_PROPERTIES* props = reinterpret_cast<EVENT_TRACE_PROPERTIES*>(properties.data());
+		ControlTrace(sessionHandle, SESSION_NAME, props, EVENT_TRACE_CONTROL_STOP);
+		sessionHandle = 0;
+	}
+
+	if (traceHandle != INVALID_PROCESSTRACE_HANDLE)
+	{
+		CloseTrace(traceHandle);
+		traceHandle = INVALID_PROCESSTRACE_HANDLE;
+	}
+
+	if (consumer.joinable())
+	{
+		consumer.join();
+	}
+}
+
+#else
+
+bool DiskIoTracer::start()
+{
+	return false;
+}
+
+void DiskIoTracer::stop()
+{
+}
+
+#endif
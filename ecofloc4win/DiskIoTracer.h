@@ -0,0 +1,203 @@
+/**
+ * @file DiskIoTracer.h
+ * @brief Implementation of the event-driven disk I/O accounting.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "IrpTable.h"
+#include "PidByteCounters.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <evntrace.h>
+#include <evntcons.h>
+#endif
+
+/**
+ * @class DiskIoTracer
+ * @brief Counts the bytes read and written on disk by every process from the kernel DiskIo events.
+ *
+ * The completion of a request does not tell which process issued it, so the pid of every initiated
+ * request (IRP) is kept until its completion gives the size of the transfer. The bytes are added to
+ * per-pid atomic counters that the sampler drains at its own pace without locking the event thread.
+ * The process start events reset the counters of a pid when Windows reuses it, the
+ * process end events give their slot back once the sampler had time to take the last bytes.
+ *
+ * On Windows the events come from a private real-time session of the kernel provider (administrator
+ * rights required); anywhere the events can also be fed with replay, which makes the accounting
+ * testable off-Windows.
+ */
+class DiskIoTracer
+{
+	public:
+
+		/**
+		* @enum EventType
+		* @brief The kernel events used by the accounting
+		*/
+		enum class EventType : uint8_t
+		{
+			ReadInit,
+			WriteInit,
+			ReadComplete,
+			WriteComplete,
+			ProcessStart,
+			ProcessEnd
+		};
+
+		/**
+		* @struct Event
+		* @brief A decoded event, the pid is only meaningful for the Init and Process events
+		*/
+		struct Event
+		{
+			EventType type;
+			uint64_t irp;
+			uint32_t pid;
+			uint32_t size;
+			uint64_t timestamp;
+		};
+
+		/**
+		* @var {size_t} PID_CAPACITY
+		* @brief The number of processes the counters can hold, a power of two
+		*/
+		static constexpr size_t PID_CAPACITY = PidByteCounters::CAPACITY;
+
+		/**
+		* @var {size_t} IRP_CAPACITY
+		* @brief The number of requests that can be in flight at once
+		*/
+		static constexpr size_t IRP_CAPACITY = 16384;
+
+		/**
+		* @var {uint64_t} IRP_TIMEOUT
+		* @brief The age after which a request without completion is forgotten, in 100ns units (10 s)
+		*/
+		static constexpr uint64_t IRP_TIMEOUT = 100000000;
+
+		/**
+		* @var {uint64_t} RELEASE_DELAY
+		* @brief The time the counters of an ended process are kept for its last completions and the
+		*        last take of the sampler, in 100ns units (10 s)
+		*/
+		static constexpr uint64_t RELEASE_DELAY = 100000000;
+
+		DiskIoTracer();
+		~DiskIoTracer();
+
+		DiskIoTracer(const DiskIoTracer&) = delete;
+		DiskIoTracer& operator=(const DiskIoTracer&) = delete;
+
+		/**
+		* @brief Starts the real-time trace session and its consumer thread
+		* @function start
+		* @returns {bool} true if the events are flowing, false otherwise (always false off-Windows),
+		*          a session of another tool is never stopped to make room for this one
+		*/
+		bool start();
+
+		/**
+		* @brief Stops the trace session and joins its consumer thread
+		* @function stop
+		*/
+		void stop();
+
+		/**
+		* @brief Accounts one event, must always be called from the same thread
+		* @function onEvent
+		* @param {Event} event - The decoded event
+		*/
+		void onEvent(const Event& event);
+
+		/**
+		* @brief Accounts a recorded stream of events as if they came from the trace session
+		* @function replay
+		* @param {std::vector<Event>} events - The events in the order they were emitted
+		*/
+		void replay(const std::vector<Event>& events);
+
+		/**
+		* @brief Takes the bytes transferred by a process since the previous call
+		* @function takeBytes
+		* @param {int} pid - The pid of the process
+		* @param {uint64_t} readBytes - A reference where the bytes read will be stored
+		* @param {uint64_t} writeBytes - A reference where the bytes written will be stored
+		* @returns {bool} true if the process did any I/O since the trace started, false otherwise
+		*/
+		bool takeBytes(int pid, uint64_t& readBytes, uint64_t& writeBytes);
+
+		/**
+		* @brief Gets the number of requests that could not be accounted because a table is full
+		* @function getDroppedEvents
+		* @returns {uint64_t} the number of dropped requests
+		*/
+		uint64_t getDroppedEvents() const;
+
+		/**
+		* @brief Gets the number of processes holding counters, ended ones included until they are released
+		* @function getTrackedProcesses
+		* @returns {size_t} the number of processes
+		*/
+		size_t getTrackedProcesses() const;
+
+	private:
+
+		/**
+		* @var {PidByteCounters} counters
+		* @brief The bytes of each process, the counter 0 for the bytes read and 1 for the bytes written
+		*/
+		PidByteCounters counters;
+
+		/**
+		* @var {IrpTable} irps
+		* @brief The initiated requests waiting for their completion, only used by the event thread
+		*/
+		IrpTable irps;
+
+		/**
+		* @var {std::atomic<uint64_t>} droppedEvents
+		* @brief The requests lost because the counters or the request table are full
+		*/
+		std::atomic<uint64_t> droppedEvents{ 0 };
+
+#ifdef _WIN32
+		/**
+		* @brief Decodes a kernel event and accounts it
+		* @param {PEVENT_RECORD} record - The event delivered by ProcessTrace
+		*/
+		static void WINAPI onEventRecord(PEVENT_RECORD record);
+
+		/**
+		* @var {std::vector<BYTE>} properties
+		* @brief The properties of the session followed by its name
+		*/
+		std::vector<BYTE> properties;
+
+		/**
+		* @var {TRACEHANDLE} sessionHandle
+		* @brief The handle of the controlled session
+		*/
+		TRACEHANDLE sessionHandle = 0;
+
+		/**
+		* @var {TRACEHANDLE} traceHandle
+		* @brief The handle of the consumed trace
+		*/
+		TRACEHANDLE traceHandle = INVALID_PROCESSTRACE_HANDLE;
+#endif
+
+		/**
+		* @var {std::thread} consumer
+		* @brief The thread delivering the events
+		*/
+		std::thread consumer;
+};
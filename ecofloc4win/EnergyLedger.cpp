@@ -0,0 +1,175 @@
+/**
+ * @file EnergyLedger.cpp
+ * @brief Definition of the energy columns of the monitored applications.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "EnergyLedger.h"
+
+#include <algorithm>
+
+/**
+ * @brief Marks the start of a write, the readers retry until the sequence is even again
+ * @function beginWrite
+ * @param {std::atomic<uint32_t>} sequence - The sequence of the written data
+ * @returns {uint32_t} the sequence to give to endWrite
+ */
+static uint32_t beginWrite(std::atomic<uint32_t>& sequence)
+{
+	uint32_t value = sequence.load(std::memory_order_relaxed);
+	sequence.store(value + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	return value + 2;
+}
+
+/**
+ * @brief Marks the end of a write
+ * @function endWrite
+ * @param {std::atomic<uint32_t>} sequence - The sequence of the written data
+ * @param {uint32_t} value - The sequence returned by beginWrite
+ */
+static void endWrite(std::atomic<uint32_t>& sequence, uint32_t value)
+{
+	sequence.store(value, std::memory_order_release);
+}
+
+void EnergyLedger::Batch::clear(size_t slotCount)
+{
+	joules.assign(slotCount, 0.0);
+	sampled.assign(slotCount, 0);
+}
+
+void EnergyLedger::Batch::set(AppId id, double energy)
+{
+	if (id.slot < joules.size())
+	{
+		joules[id.slot] = energy;
+		sampled[id.slot] = 1;
+	}
+}
+
+EnergyLedger::EnergyLedger() : columns(new Column[COMPONENT_COUNT])
+{
+	for (size_t component = 0; component < COMPONENT_COUNT; component++)
+	{
+		Column& column = columns[component];
+		for (size_t slot = 0; slot < CAPACITY; slot++)
+		{
+			column.generation[slot].store(UNCLAIMED, std::memory_order_relaxed);
+			column.joules[slot].store(0.0, std::memory_order_relaxed);
+			column.updated[slot].store(0, std::memory_order_relaxed);
+			column.watts[slot].store(0.0, std::memory_order_relaxed);
+			column.powerGeneration[slot].store(UNCLAIMED, std::memory_order_relaxed);
+		}
+		std::fill(std::begin(column.pendingJoules), std::end(column.pendingJoules), 0.0);
+		std::fill(std::begin(column.pendingUpdated), std::end(column.pendingUpdated), 0);
+	}
+}
+
+void EnergyLedger::claim(ComponentType component, AppId id)
+{
+	Column& column = columns[static_cast<size_t>(component)];
+	if (id.slot >= CAPACITY || column.generation[id.slot].load(std::memory_order_relaxed) == id.generation)
+	{
+		return;
+	}
+
+	column.pendingJoules[id.slot] = 0.0;
+	column.pendingUpdated[id.slot] = 0;
+
+	uint32_t sequence = beginWrite(column.energySequence);
+	column.generation[id.slot].store(id.generation, std::memory_order_relaxed);
+	column.joules[id.slot].store(0.0, std::memory_order_relaxed);
+	column.updated[id.slot].store(0, std::memory_order_relaxed);
+	endWrite(column.energySequence, sequence);
+}
+
+void EnergyLedger::accumulate(ComponentType component, const Batch& batch, Clock::time_point end)
+{
+	Column& column = columns[static_cast<size_t>(component)];
+	const size_t count = std::min(batch.joules.size(), CAPACITY);
+	const Clock::rep endTime = end.time_since_epoch().count();
+	const double* joules = batch.joules.data();
+	const uint8_t* sampled = batch.sampled.data();
+
+	// Branchless loops over the contiguous slots of the private copy, both are vectorized
+	double* pendingJoules = column.pendingJoules;
+	for (size_t slot = 0; slot < count; slot++)
+	{
+		pendingJoules[slot] += joules[slot];
+	}
+
+	Clock::rep* pendingUpdated = column.pendingUpdated;
+	for (size_t slot = 0; slot < count; slot++)
+	{
+		pendingUpdated[slot] = sampled[slot] ? endTime : pendingUpdated[slot];
+	}
+
+	// The relaxed stores are plain moves, only their order with the sequence matters
+	uint32_t sequence = beginWrite(column.energySequence);
+	for (size_t slot = 0; slot < count; slot++)
+	{
+		column.joules[slot].store(pendingJoules[slot], std::memory_order_relaxed);
+		column.updated[slot].store(pendingUpdated[slot], std::memory_order_relaxed);
+	}
+	endWrite(column.energySequence, sequence);
+}
+
+void EnergyLedger::setPowers(ComponentType component, const double* watts, const uint32_t* generations, size_t count)
+{
+	Column& column = columns[static_cast<size_t>(component)];
+	count = std::min(count, CAPACITY);
+
+	uint32_t sequence = beginWrite(column.powerSequence);
+	for (size_t slot = 0; slot < CAPACITY; slot++)
+	{
+		column.watts[slot].store(slot < count ? watts[slot] : 0.0, std::memory_order_relaxed);
+		column.powerGeneration[slot].store(slot < count ? generations[slot] : UNCLAIMED, std::memory_order_relaxed);
+	}
+	endWrite(column.powerSequence, sequence);
+}
+
+void EnergyLedger::read(ComponentType component, const std::vector<AppId>& ids, std::vector<Reading>& readings) const
+{
+	const Column& column = columns[static_cast<size_t>(component)];
+	readings.resize(ids.size());
+
+	// The powers and the energies have different writers, each is read under its own sequence; the power of
+	// a slot belongs to the application it was computed for, a reused slot has none until the next frame
+	uint32_t before, after;
+	do
+	{
+		before = column.powerSequence.load(std::memory_order_acquire);
+		for (size_t i = 0; i < ids.size(); i++)
+		{
+			AppId id = ids[i];
+			bool current = id.slot < CAPACITY && column.powerGeneration[id.slot].load(std::memory_order_relaxed) == id.generation;
+			readings[i].watts = current ? column.watts[id.slot].load(std::memory_order_relaxed) : 0.0;
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		after = column.powerSequence.load(std::memory_order_relaxed);
+	} while ((before & 1) != 0 || before != after);
+
+	// A slot claimed by an older application gives nothing, the power of the previous frame included,
+	// the powers are only masked once the energies are consistent
+	std::vector<uint8_t> claimed(ids.size());
+	do
+	{
+		before = column.energySequence.load(std::memory_order_acquire);
+		for (size_t i = 0; i < ids.size(); i++)
+		{
+			AppId id = ids[i];
+			claimed[i] = id.slot < CAPACITY && column.generation[id.slot].load(std::memory_order_relaxed) == id.generation;
+			readings[i].joules = claimed[i] ? column.joules[id.slot].load(std::memory_order_relaxed) : 0.0;
+			readings[i].updated = Clock::time_point(Clock::duration(claimed[i] ? column.updated[id.slot].load(std::memory_order_relaxed) : 0));
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		after = column.energySequence.load(std::memory_order_relaxed);
+	} while ((before & 1) != 0 || before != after);
+
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		readings[i].watts = claimed[i] ? readings[i].watts : 0.0;
+	}
+}
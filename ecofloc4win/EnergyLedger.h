@@ -0,0 +1,168 @@
+/**
+ * @file EnergyLedger.h
+ * @brief Implementation of the energy columns of the monitored applications.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "AppSlots.h"
+#include "ComponentType.h"
+
+/**
+ * @class EnergyLedger
+ * @brief The energies and powers of every application, stored in one dense column per component.
+ *
+ * Each column holds the joules, the power and the time of the last sample of every application,
+ * indexed by the slot of its identifier. A sampler adds the energies of a whole tick to its own copy
+ * of the column in one contiguous pass the compiler vectorizes, instead of updating each application
+ * on its own, then publishes the sums.
+ *
+ * The energies of a column are only written by the sampler of its component and its powers by the
+ * clock thread, each under its own sequence counter. The published slots are relaxed atomics, so a
+ * reader racing a write is well defined; it retries while a write is in progress and never blocks
+ * the writers.
+ */
+class EnergyLedger
+{
+	public:
+
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		* @var {size_t} CAPACITY
+		* @brief The number of slots of each column, the applications beyond it can not be monitored
+		*/
+		static constexpr size_t CAPACITY = 1024;
+
+		/**
+		* @struct Reading
+		* @brief What a column holds for one application
+		*/
+		struct Reading
+		{
+			double joules;
+			double watts;
+			Clock::time_point updated;
+		};
+
+		/**
+		* @class Batch
+		* @brief The energies of one tick of a sampler, dense by slot and reused from one tick to the next
+		*/
+		class Batch
+		{
+			public:
+
+				/**
+				* @brief Empties the batch for a new tick
+				* @function clear
+				* @param {size_t} slotCount - The number of slots of the monitored list, every slot index is below it
+				*/
+				void clear(size_t slotCount);
+
+				/**
+				* @brief Sets the energy of an application during the tick
+				* @function set
+				* @param {AppId} id - The application
+				* @param {double} energy - The energy in Joules used during the tick
+				*/
+				void set(AppId id, double energy);
+
+			private:
+
+				friend class EnergyLedger;
+
+				/**
+				* @var {std::vector<double>} joules
+				* @brief The energy of each slot, 0 for the slots not sampled
+				*/
+				std::vector<double> joules;
+
+				/**
+				* @var {std::vector<uint8_t>} sampled
+				* @brief 1 for the slots sampled during the tick, 0 otherwise
+				*/
+				std::vector<uint8_t> sampled;
+		};
+
+		EnergyLedger();
+
+		/**
+		* @brief Gives the slot of an application to it in a column, its energy starts from zero if the slot was used before
+		* @function claim
+		* @param {ComponentType} component - The column, only called by the sampler writing it
+		* @param {AppId} id - The application
+		*/
+		void claim(ComponentType component, AppId id);
+
+		/**
+		* @brief Adds the energies of a tick to a column
+		* @function accumulate
+		* @param {ComponentType} component - The column, only called by the sampler writing it
+		* @param {Batch} batch - The energies of the tick
+		* @param {Clock::time_point} end - The end of the tick
+		*/
+		void accumulate(ComponentType component, const Batch& batch, Clock::time_point end);
+
+		/**
+		* @brief Replaces the powers of a column, the slots after count are set to 0
+		* @function setPowers
+		* @param {ComponentType} component - The column, only called by the clock thread
+		* @param {const double*} watts - The power of each slot during the last output frame
+		* @param {const uint32_t*} generations - The generation of the application each power belongs to
+		* @param {size_t} count - The number of slots given, at most CAPACITY
+		*/
+		void setPowers(ComponentType component, const double* watts, const uint32_t* generations, size_t count);
+
+		/**
+		* @brief Reads a column for several applications at once
+		* @function read
+		* @param {ComponentType} component - The column
+		* @param {std::vector<AppId>} ids - The applications
+		* @param {std::vector<Reading>} readings - A reference where the reading of each application is stored, zero if not claimed
+		*/
+		void read(ComponentType component, const std::vector<AppId>& ids, std::vector<Reading>& readings) const;
+
+	private:
+
+		/**
+		* @struct Column
+		* @brief The slots of one component, on their own cache lines so the samplers do not share any
+		*
+		* The pending arrays are the copy of the energies only the sampler of the component touches,
+		* the sums are made there and then stored in the published arrays.
+		*/
+		struct alignas(64) Column
+		{
+			std::atomic<uint32_t> energySequence{ 0 };
+			std::atomic<uint32_t> powerSequence{ 0 };
+			std::atomic<uint32_t> generation[CAPACITY];
+			std::atomic<double> joules[CAPACITY];
+			std::atomic<Clock::rep> updated[CAPACITY];
+			std::atomic<double> watts[CAPACITY];
+			std::atomic<uint32_t> powerGeneration[CAPACITY];
+			double pendingJoules[CAPACITY];
+			Clock::rep pendingUpdated[CAPACITY];
+		};
+
+		/**
+		* @var {uint32_t} UNCLAIMED
+		* @brief The generation of a slot no application claimed yet
+		*/
+		static constexpr uint32_t UNCLAIMED = UINT32_MAX;
+
+		/**
+		* @var {std::unique_ptr<Column[]>} columns
+		* @brief One column per component, indexed by ComponentType
+		*/
+		std::unique_ptr<Column[]> columns;
+};
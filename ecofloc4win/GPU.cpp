@@ -0,0 +1,561 @@
+/**
+ * @file GPU.cpp
+ * @brief Definition of GPU management features.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "GPU.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+/**
+ * @brief Defines NVML types and constants
+ * @{
+ */
+#define NVML_SUCCESS 0
+#define NVML_ERROR_NOT_SUPPORTED 3
+#define NVML_ERROR_NOT_FOUND 6
+#define NVML_ERROR_INSUFFICIENT_SIZE 7
+
+typedef int nvmlReturn_t;
+typedef void* nvmlDevice_t;
+
+typedef struct nvmlUtilization_st 
+{
+    unsigned int gpu;
+    unsigned int memory;
+} nvmlUtilization_t;
+
+typedef struct nvmlProcessInfo_st 
+{
+    unsigned int pid;
+    unsigned long long usedGpuMemory;
+} nvmlProcessInfo_t;
+
+typedef struct nvmlProcessUtilizationSample_st
+{
+    unsigned int pid;
+    unsigned long long timeStamp;
+    unsigned int smUtil;
+    unsigned int memUtil;
+    unsigned int encUtil;
+    unsigned int decUtil;
+} nvmlProcessUtilizationSample_t;
+
+/**
+ * @brief Defines function pointers for NVML functions
+ */
+typedef nvmlReturn_t(*NvmlInit_t)();
+typedef nvmlReturn_t(*NvmlShutdown_t)();
+typedef nvmlReturn_t(*NvmlDeviceGetCount_t)(unsigned int*);
+typedef nvmlReturn_t(*NvmlDeviceGetHandleByIndex_t)(unsigned int, nvmlDevice_t*);
+typedef nvmlReturn_t(*NvmlDeviceGetUtilizationRates_t)(nvmlDevice_t, nvmlUtilization_t*);
+typedef nvmlReturn_t(*NvmlDeviceGetComputeRunningProcesses_t)(nvmlDevice_t, unsigned int*, nvmlProcessInfo_t*);
+typedef nvmlReturn_t(*NvmlDeviceGetPowerUsage_t)(nvmlDevice_t, unsigned int*);
+typedef nvmlReturn_t(*NvmlDeviceGetProcessUtilization_t)(nvmlDevice_t, nvmlProcessUtilizationSample_t*, unsigned int*, unsigned long long);
+typedef nvmlReturn_t(*NvmlDeviceGetTotalEnergyConsumption_t)(nvmlDevice_t, unsigned long long*);
+typedef const char* (*NvmlErrorString_t)(nvmlReturn_t);
+
+/**
+ * @brief Loads the NVML library installed with the driver
+ * @function openLibrary
+ * @returns {void*} the handle of the library, nullptr if it is not installed
+ */
+static void* openLibrary()
+{
+#ifdef _WIN32
+    return LoadLibrary(L"nvml.dll");
+#else
+    return dlopen("libnvml.so.1", RTLD_NOW);
+#endif
+}
+
+/**
+ * @brief Finds a function exported by the NVML library
+ * @function findFunction
+ * @param {void*} library - the handle returned by openLibrary
+ * @param {const char*} name - the name of the function
+ * @returns {Function} the function, nullptr if the library does not export it
+ */
+template <typename Function>
+static Function findFunction(void* library, const char* name)
+{
+#ifdef _WIN32
+    return reinterpret_cast<Function>(GetProcAddress(static_cast<HMODULE>(library), name));
+#else
+    return reinterpret_cast<Function>(dlsym(library, name));
+#endif
+}
+
+/**
+ * @brief Unloads the NVML library
+ * @function closeLibrary
+ * @param {void*} library - the handle returned by openLibrary
+ */
+static void closeLibrary(void* library)
+{
+#ifdef _WIN32
+    FreeLibrary(static_cast<HMODULE>(library));
+#else
+    dlclose(library);
+#endif
+}
+
+/**
+ * @struct DeviceState
+ * @brief What is kept about a device between two ticks
+ */
+struct DeviceState
+{
+    nvmlDevice_t handle = nullptr;
+    unsigned long long lastSeenTimeStamp = 0;
+    bool hasEnergyCounter = true;
+    unsigned long long lastEnergy = 0;
+    bool started = false;
+    std::chrono::steady_clock::time_point lastTime;
+    std::vector<nvmlProcessInfo_t> processInfo = std::vector<nvmlProcessInfo_t>(32);
+    std::vector<nvmlProcessUtilizationSample_t> utilizations = std::vector<nvmlProcessUtilizationSample_t>(32);
+};
+
+/**
+ * @class NVMLManager
+ * @brief Class for NVMLManager-related functionalities.
+ *
+ * NVML is loaded and initialized once, the device handles are cached for the lifetime of the program.
+ */
+class NVMLManager 
+{
+    public:
+        static NVMLManager& getInstance() 
+        {
+            static NVMLManager instance;
+            return instance;
+        }
+
+        bool initialize() 
+        {
+            if (initialized)
+            {
+                return true;
+            }
+
+            // Only try once, a missing driver will not appear while the program runs
+            if (failed)
+            {
+                return false;
+            }
+            failed = true;
+
+            if (!nvmlLib) 
+            {
+                nvmlLib = openLibrary();
+                if (!nvmlLib) 
+                {
+                    std::cerr << "NVML library not found. Ensure NVIDIA drivers are installed.\n";
+                    return false;
+                }
+
+                nvmlInit = findFunction<NvmlInit_t>(nvmlLib, "nvmlInit");
+                nvmlShutdown = findFunction<NvmlShutdown_t>(nvmlLib, "nvmlShutdown");
+                nvmlDeviceGetCount = findFunction<NvmlDeviceGetCount_t>(nvmlLib, "nvmlDeviceGetCount");
+                nvmlDeviceGetHandleByIndex = findFunction<NvmlDeviceGetHandleByIndex_t>(nvmlLib, "nvmlDeviceGetHandleByIndex");
+                nvmlDeviceGetUtilizationRates = findFunction<NvmlDeviceGetUtilizationRates_t>(nvmlLib, "nvmlDeviceGetUtilizationRates");
+                nvmlDeviceGetComputeRunningProcesses = findFunction<NvmlDeviceGetComputeRunningProcesses_t>(nvmlLib, "nvmlDeviceGetComputeRunningProcesses");
+                nvmlDeviceGetPowerUsage = findFunction<NvmlDeviceGetPowerUsage_t>(nvmlLib, "nvmlDeviceGetPowerUsage");
+                nvmlErrorString = findFunction<NvmlErrorString_t>(nvmlLib, "nvmlErrorString");
+
+                // Optional, older drivers only report the utilization of the whole device
+                nvmlDeviceGetProcessUtilization = findFunction<NvmlDeviceGetProcessUtilization_t>(nvmlLib, "nvmlDeviceGetProcessUtilization");
+                nvmlDeviceGetTotalEnergyConsumption = findFunction<NvmlDeviceGetTotalEnergyConsumption_t>(nvmlLib, "nvmlDeviceGetTotalEnergyConsumption");
+
+                if (!nvmlInit || !nvmlShutdown
+                || !nvmlDeviceGetCount || !nvmlDeviceGetHandleByIndex
+                || !nvmlDeviceGetUtilizationRates || !nvmlDeviceGetComputeRunningProcesses
+                || !nvmlDeviceGetPowerUsage || !nvmlErrorString) 
+                {
+                    std::cerr << "Failed to locate NVML functions in the library.\n";
+                    closeLibrary(nvmlLib);
+                    nvmlLib = nullptr;
+                    return false;
+                }
+            }
+
+            nvmlReturn_t result = nvmlInit();
+            if (result != NVML_SUCCESS)
+            {
+                std::cerr << "Failed to initialize NVML: " << nvmlErrorString(result) << std::endl;
+                return false;
+            }
+
+            unsigned int deviceCount = 0;
+            result = nvmlDeviceGetCount(&deviceCount);
+            if (result != NVML_SUCCESS)
+            {
+                std::cerr << "Failed to get device count: " << nvmlErrorString(result) << std::endl;
+                nvmlShutdown();
+                return false;
+            }
+
+            devices.assign(deviceCount, DeviceState());
+            for (unsigned int i = 0; i < deviceCount; ++i)
+            {
+                result = nvmlDeviceGetHandleByIndex(i, &devices[i].handle);
+                if (result != NVML_SUCCESS)
+                {
+                    std::cerr << "Failed to get handle for device " << i << ": " << nvmlErrorString(result) << std::endl;
+                    devices[i].handle = nullptr;
+                }
+                devices[i].hasEnergyCounter = nvmlDeviceGetTotalEnergyConsumption != nullptr;
+            }
+
+            initialized = true;
+            failed = false;
+            return true;
+        }
+
+        void shutdown() 
+        {
+            // The next initialization may try again
+            failed = false;
+
+            if (initialized)
+            {
+                nvmlShutdown();
+                devices.clear();
+                initialized = false;
+            }
+
+            if (nvmlLib) 
+            {
+                closeLibrary(nvmlLib);
+                nvmlLib = nullptr;
+            }
+        }
+
+        /**
+         * @brief Gets the number of devices found at initialization
+         * @function getDeviceCount
+         * @returns {unsigned int} the number of devices
+         */
+        unsigned int getDeviceCount() const
+        {
+            return static_cast<unsigned int>(devices.size());
+        }
+
+        /**
+         * @brief Gets the cached handle of a device
+         * @function getDevice
+         * @param {unsigned int} index - the NVML index of the device
+         * @returns {nvmlDevice_t} the handle, nullptr if it could not be retrieved
+         */
+        nvmlDevice_t getDevice(unsigned int index) const
+        {
+            return index < devices.size() ? devices[index].handle : nullptr;
+        }
+
+        /**
+         * @brief Gets what is kept about a device between two ticks
+         * @function getState
+         * @param {unsigned int} index - the NVML index of the device
+         * @returns {DeviceState&} the state of the device
+         */
+        DeviceState& getState(unsigned int index)
+        {
+            return devices[index];
+        }
+
+        NvmlInit_t nvmlInit = nullptr;
+        NvmlShutdown_t nvmlShutdown = nullptr;
+        NvmlDeviceGetCount_t nvmlDeviceGetCount = nullptr;
+        NvmlDeviceGetHandleByIndex_t nvmlDeviceGetHandleByIndex = nullptr;
+        NvmlDeviceGetUtilizationRates_t nvmlDeviceGetUtilizationRates = nullptr;
+        NvmlDeviceGetComputeRunningProcesses_t nvmlDeviceGetComputeRunningProcesses = nullptr;
+        NvmlDeviceGetPowerUsage_t nvmlDeviceGetPowerUsage = nullptr;
+        NvmlDeviceGetProcessUtilization_t nvmlDeviceGetProcessUtilization = nullptr;
+        NvmlDeviceGetTotalEnergyConsumption_t nvmlDeviceGetTotalEnergyConsumption = nullptr;
+        NvmlErrorString_t nvmlErrorString = nullptr;
+
+    private:
+        NVMLManager() = default;
+        ~NVMLManager() 
+        {
+            shutdown();
+        }
+
+        void* nvmlLib = nullptr;
+        bool initialized = false;
+        bool failed = false;
+        std::vector<DeviceState> devices;
+};
+
+/**
+ * @}
+ */
+
+namespace GPU 
+{
+    int initNVML() 
+    {
+        NVMLManager& nvml = NVMLManager::getInstance();
+        if (!nvml.initialize()) 
+        {
+            return 1;
+        }
+
+        std::cout << "NVML initialized successfully.\n";
+        return 0;
+    }
+
+    void shutdownNVML()
+    {
+        NVMLManager::getInstance().shutdown();
+    }
+
+    /**
+     * @brief Splits the power of a device between its processes from their utilization samples
+     *
+     * Each process gets the part of the device it used (SM, encoder and decoder) since the previous call,
+     * the shares are scaled down when the processes add up to more than the whole device.
+     *
+     * @param nvml The initialized manager.
+     * @param index The NVML index of the device.
+     * @param sample The sample of the device where the shares are stored.
+     * @return bool True if the device reported per-process samples, false otherwise.
+     */
+    static bool sampleProcessShares(NVMLManager& nvml, unsigned int index, DeviceSample& sample)
+    {
+        if (!nvml.nvmlDeviceGetProcessUtilization)
+        {
+            return false;
+        }
+
+        nvmlDevice_t device = nvml.getDevice(index);
+        DeviceState& state = nvml.getState(index);
+        std::vector<nvmlProcessUtilizationSample_t>& utilizations = state.utilizations;
+
+        // The buffer is kept between ticks and only grows when the driver reports more samples than it holds
+        unsigned int count = static_cast<unsigned int>(utilizations.size());
+        nvmlReturn_t result = nvml.nvmlDeviceGetProcessUtilization(device, utilizations.data(), &count, state.lastSeenTimeStamp);
+        while (result == NVML_ERROR_INSUFFICIENT_SIZE)
+        {
+            utilizations.resize(std::max<size_t>(count, utilizations.size() * 2));
+            count = static_cast<unsigned int>(utilizations.size());
+            result = nvml.nvmlDeviceGetProcessUtilization(device, utilizations.data(), &count, state.lastSeenTimeStamp);
+        }
+
+        if (result == NVML_ERROR_NOT_FOUND)
+        {
+            // Nothing ran on the device since the last call
+            return true;
+        }
+
+        if (result != NVML_SUCCESS)
+        {
+            if (result != NVML_ERROR_NOT_SUPPORTED)
+            {
+                std::cerr << "Failed to get process utilization for device " << index << ": " << nvml.nvmlErrorString(result) << std::endl;
+            }
+            return false;
+        }
+
+        // A process may appear in several samples, average its load over them
+        std::vector<ProcessShare> loads;
+        std::vector<unsigned int> sampleCounts;
+        std::unordered_map<unsigned int, size_t> loadIndex;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            const nvmlProcessUtilizationSample_t& utilization = utilizations[i];
+            state.lastSeenTimeStamp = std::max(state.lastSeenTimeStamp, utilization.timeStamp);
+
+            auto inserted = loadIndex.emplace(utilization.pid, loads.size());
+            if (inserted.second)
+            {
+                loads.push_back({ utilization.pid, 0.0 });
+                sampleCounts.push_back(0);
+            }
+
+            size_t j = inserted.first->second;
+            loads[j].share += utilization.smUtil + utilization.encUtil + utilization.decUtil;
+            sampleCounts[j]++;
+        }
+
+        double totalLoad = 0.0;
+        for (size_t i = 0; i < loads.size(); ++i)
+        {
+            loads[i].share /= sampleCounts[i];
+            totalLoad += loads[i].share;
+        }
+
+        double scale = 1.0 / std::max(100.0, totalLoad);
+        for (ProcessShare& load : loads)
+        {
+            load.share *= scale;
+        }
+
+        sample.processes = std::move(loads);
+        return true;
+    }
+
+    /**
+     * @brief Reads the energy used by a device since the previous tick
+     *
+     * The total energy counter of the device is used when it exists, so the power does not have to be polled
+     * at the sampling rate. Otherwise the current power is held over the time elapsed since the previous tick.
+     *
+     * @param nvml The initialized manager.
+     * @param index The NVML index of the device.
+     * @param sample The sample of the device where the energy and the average power are stored.
+     * @return bool True if the energy was read, false otherwise.
+     */
+    static bool readDeviceEnergy(NVMLManager& nvml, unsigned int index, DeviceSample& sample)
+    {
+        nvmlDevice_t device = nvml.getDevice(index);
+        DeviceState& state = nvml.getState(index);
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = state.started ? std::chrono::duration<double>(now - state.lastTime).count() : 0.0;
+
+        if (state.hasEnergyCounter)
+        {
+            // Total energy in millijoules since the driver was loaded
+            unsigned long long energy;
+            nvmlReturn_t result = nvml.nvmlDeviceGetTotalEnergyConsumption(device, &energy);
+            if (result == NVML_SUCCESS)
+            {
+                sample.energy = state.started && energy >= state.lastEnergy ? (energy - state.lastEnergy) / 1000.0 : 0.0;
+                sample.power = elapsed > 0.0 ? sample.energy / elapsed : 0.0;
+
+                state.lastEnergy = energy;
+                state.lastTime = now;
+                state.started = true;
+                return true;
+            }
+
+            if (result != NVML_ERROR_NOT_SUPPORTED)
+            {
+                std::cerr << "Failed to read total energy for device " << index << ": " << nvml.nvmlErrorString(result) << std::endl;
+                return false;
+            }
+
+            state.hasEnergyCounter = false;
+        }
+
+        // Read power usage (in milliwatts)
+        unsigned int power;
+        nvmlReturn_t result = nvml.nvmlDeviceGetPowerUsage(device, &power);
+        if (result != NVML_SUCCESS) 
+        {
+            std::cerr << "Failed to read power usage for device " << index << ": " << nvml.nvmlErrorString(result) << std::endl;
+            return false;
+        }
+
+        sample.power = power / 1000.0;
+        sample.energy = sample.power * elapsed;
+
+        state.lastTime = now;
+        state.started = true;
+        return true;
+    }
+
+    std::vector<DeviceSample> sampleDevices()
+    {
+        NVMLManager& nvml = NVMLManager::getInstance();
+        if (!nvml.initialize()) 
+        {
+            return {};
+        }
+
+        std::vector<DeviceSample> samples(nvml.getDeviceCount());
+        for (unsigned int i = 0; i < nvml.getDeviceCount(); ++i)
+        {
+            nvmlDevice_t device = nvml.getDevice(i);
+            if (!device)
+            {
+                continue;
+            }
+
+            DeviceSample& sample = samples[i];
+            if (!readDeviceEnergy(nvml, i, sample))
+            {
+                continue;
+            }
+
+            // The per-process samples are enough when the device reports them, the utilization
+            // and the running processes are only read for the approximation
+            if (sampleProcessShares(nvml, i, sample))
+            {
+                sample.valid = true;
+                continue;
+            }
+
+            // Get GPU utilization rates
+            nvmlUtilization_t utilization;
+            nvmlReturn_t result = nvml.nvmlDeviceGetUtilizationRates(device, &utilization);
+            if (result != NVML_SUCCESS) 
+            {
+                std::cerr << "Failed to get utilization rates for device " << i << ": " << nvml.nvmlErrorString(result) << std::endl;
+                continue;
+            }
+
+            // Get running processes on the device, growing the kept buffer when it is too small
+            std::vector<nvmlProcessInfo_t>& processInfo = nvml.getState(i).processInfo;
+            unsigned int infoCount = static_cast<unsigned int>(processInfo.size());
+            result = nvml.nvmlDeviceGetComputeRunningProcesses(device, &infoCount, processInfo.data());
+            while (result == NVML_ERROR_INSUFFICIENT_SIZE)
+            {
+                processInfo.resize(std::max<size_t>(infoCount, processInfo.size() * 2));
+                infoCount = static_cast<unsigned int>(processInfo.size());
+                result = nvml.nvmlDeviceGetComputeRunningProcesses(device, &infoCount, processInfo.data());
+            }
+
+            if (result != NVML_SUCCESS) 
+            {
+                std::cerr << "Failed to get running processes for device " << i << ": " << nvml.nvmlErrorString(result) << std::endl;
+                continue;
+            }
+
+            sample.valid = true;
+            sample.utilization = utilization.gpu;
+
+            // Approximation when the device has no per-process samples: the GPU utilization is split evenly
+            // between the running processes, so their shares never add up to more than the device
+            for (unsigned int j = 0; j < infoCount; ++j)
+            {
+                sample.processes.push_back({ processInfo[j].pid, utilization.gpu / 100.0 / infoCount });
+            }
+        }
+
+        return samples;
+    }
+
+    std::vector<double> getGPUJoules(const std::vector<DeviceSample>& samples, const std::unordered_set<int>& pids)
+    {
+        std::vector<double> results(samples.size(), 0.0);
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            if (!samples[i].valid)
+            {
+                continue;
+            }
+
+            for (const ProcessShare& process : samples[i].processes)
+            {
+                if (pids.count(static_cast<int>(process.pid)) > 0)
+                {
+                    results[i] += process.share * samples[i].energy;
+                }
+            }
+        }
+        return results;
+    }
+}
@@ -0,0 +1,64 @@
+/**
+ * @file GPU.h
+ * @brief Implementation of GPU management features.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @namespace GPU
+ * @brief Namespace for GPU-related functionalities.
+ */
+namespace GPU
+{
+	/**
+	 * @struct ProcessShare
+	 * @brief The part of a GPU used by a process during the last tick
+	 */
+	struct ProcessShare
+	{
+		unsigned int pid;
+		double share;
+	};
+
+	/**
+	 * @struct DeviceSample
+	 * @brief The state of one GPU read once per tick
+	 */
+	struct DeviceSample
+	{
+		bool valid = false;
+		unsigned int utilization = 0; // Only read when the device has no per-process samples
+		double power = 0.0;
+		double energy = 0.0;
+		std::vector<ProcessShare> processes;
+	};
+
+	/**
+	 * @brief Reads the energy and the share of each process of every GPU once
+	 * @function sampleDevices
+	 * @returns {std::vector<DeviceSample>} one sample per GPU, in the order of the NVML indices,
+	 *          the energy of each sample is the one used since the previous call
+	 */
+	std::vector<DeviceSample> sampleDevices();
+
+	/**
+	 * @brief Gets the energy used on each GPU by a list of pids during a tick
+	 * @function getGPUJoules
+	 * @param {std::vector<DeviceSample>} samples - the samples of the tick
+	 * @param {std::unordered_set<int>} pids - set of pids
+	 * @returns {std::vector<double>} the energy in Joules used by the pids on each GPU
+	 */
+	std::vector<double> getGPUJoules(const std::vector<DeviceSample>& samples, const std::unordered_set<int>& pids);
+
+	/**
+	 * @brief Releases NVML and forgets what was kept about every device, the next sample initializes it again
+	 * @function shutdownNVML
+	 */
+	void shutdownNVML();
+};
@@ -0,0 +1,181 @@
+/**
+ * @file InstanceIndex.cpp
+ * @brief Definition of the PID to performance counter instance index.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "InstanceIndex.h"
+#include "CounterDictionary.h"
+
+#include <iostream>
+
+InstanceIndex::~InstanceIndex()
+{
+	if (query)
+	{
+		PdhCloseQuery(query);
+	}
+}
+
+bool InstanceIndex::open()
+{
+	if (query)
+	{
+		return true;
+	}
+
+	std::wstring queryPath = CounterDictionary::getInstance().getProcessCounterPath(L"*", "ID Process");
+	if (queryPath.empty())
+	{
+		return false;
+	}
+
+	if (PdhOpenQuery(nullptr, 0, &query) != ERROR_SUCCESS)
+	{
+		std::cerr << "Failed to open PDH query." << std::endl;
+		query = nullptr;
+		return false;
+	}
+
+	if (PdhAddCounter(query, queryPath.c_str(), 0, &pidCounter) != ERROR_SUCCESS)
+	{
+		std::cerr << "Failed to add counter for process ID." << std::endl;
+		PdhCloseQuery(query);
+		query = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+bool InstanceIndex::refresh()
+{
+	if (!open())
+	{
+		return false;
+	}
+
+	if (PdhCollectQueryData(query) != ERROR_SUCCESS)
+	{
+		std::cerr << "Failed to collect query data." << std::endl;
+		return false;
+	}
+
+	DWORD bufferSize = static_cast<DWORD>(buffer.size());
+	DWORD itemCount = 0;
+	PDH_STATUS status;
+	while ((status = PdhGetRawCounterArray(pidCounter, &bufferSize, &itemCount,
+		buffer.empty() ? nullptr : reinterpret_cast<PDH_RAW_COUNTER_ITEM*>(buffer.data()))) == PDH_MORE_DATA)
+	{
+		buffer.resize(bufferSize);
+	}
+
+	if (status != ERROR_SUCCESS)
+	{
+		std::cerr << "Failed to get counter array." << std::endl;
+		return false;
+	}
+
+	const PDH_RAW_COUNTER_ITEM* items = reinterpret_cast<const PDH_RAW_COUNTER_ITEM*>(buffer.data());
+	positions.clear();
+
+	for (DWORD i = 0; i < itemCount; ++i)
+	{
+		int pid = static_cast<int>(items[i].RawValue.FirstValue);
+
+		// Idle and _Total both report the pid 0
+		if (pid == 0)
+		{
+			continue;
+		}
+
+		positions[pid] = i;
+	}
+
+	for (WildcardCounter& counter : counters)
+	{
+		readCounter(counter, itemCount);
+	}
+
+	return true;
+}
+
+void InstanceIndex::readCounter(WildcardCounter& counter, DWORD itemCount)
+{
+	counter.values.assign(itemCount, 0.0);
+	counter.valid.assign(itemCount, false);
+
+	DWORD bufferSize = static_cast<DWORD>(counter.buffer.size());
+	DWORD count = 0;
+	PDH_STATUS status;
+	while ((status = PdhGetFormattedCounterArray(counter.handle, PDH_FMT_DOUBLE, &bufferSize, &count,
+		counter.buffer.empty() ? nullptr : reinterpret_cast<PDH_FMT_COUNTERVALUE_ITEM*>(counter.buffer.data()))) == PDH_MORE_DATA)
+	{
+		counter.buffer.resize(bufferSize);
+	}
+
+	// A rate counter has no value until its second collection
+	if (status != ERROR_SUCCESS)
+	{
+		return;
+	}
+
+	// Both arrays come from the same collection, a different count means the counter was added in between
+	if (count != itemCount)
+	{
+		return;
+	}
+
+	const PDH_FMT_COUNTERVALUE_ITEM* items = reinterpret_cast<const PDH_FMT_COUNTERVALUE_ITEM*>(counter.buffer.data());
+	for (DWORD i = 0; i < count; ++i)
+	{
+		if (items[i].FmtValue.CStatus == PDH_CSTATUS_VALID_DATA || items[i].FmtValue.CStatus == PDH_CSTATUS_NEW_DATA)
+		{
+			counter.values[i] = items[i].FmtValue.doubleValue;
+			counter.valid[i] = true;
+		}
+	}
+}
+
+int InstanceIndex::addCounter(const std::string& counterName)
+{
+	if (!open())
+	{
+		return -1;
+	}
+
+	std::wstring counterPath = CounterDictionary::getInstance().getProcessCounterPath(L"*", counterName);
+	if (counterPath.empty())
+	{
+		return -1;
+	}
+
+	PDH_HCOUNTER handle;
+	if (PdhAddCounter(query, counterPath.c_str(), 0, &handle) != ERROR_SUCCESS)
+	{
+		std::cerr << "Failed to add PDH counter: " << counterName << std::endl;
+		return -1;
+	}
+
+	counters.push_back({ handle, {}, {}, {} });
+	return static_cast<int>(counters.size()) - 1;
+}
+
+bool InstanceIndex::getValue(int pid, int counterId, double& value) const
+{
+	if (counterId < 0 || counterId >= static_cast<int>(counters.size()))
+	{
+		return false;
+	}
+
+	auto it = positions.find(pid);
+	const WildcardCounter& counter = counters[counterId];
+	if (it == positions.end() || it->second >= counter.valid.size() || !counter.valid[it->second])
+	{
+		return false;
+	}
+
+	value = counter.values[it->second];
+	return true;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file InstanceIndex.h
+ * @brief Implementation of the PID to performance counter instance index.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <windows.h>
+#include <Pdh.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class InstanceIndex
+ * @brief Maps the pid of every process to the position of its instance in the Process counters.
+ *
+ * A single wildcard "ID Process" query is kept open for the whole run and collected once per refresh.
+ * The positions are rebuilt on every refresh because Windows renumbers the "name#N" instances
+ * when a process sharing the same name exits.
+ *
+ * Other wildcard counters can be added to the same query: all the arrays of one collection list the
+ * instances in the same order, so their values are joined to the pids by position.
+ */
+class InstanceIndex
+{
+	public:
+		InstanceIndex() = default;
+		~InstanceIndex();
+
+		InstanceIndex(const InstanceIndex&) = delete;
+		InstanceIndex& operator=(const InstanceIndex&) = delete;
+
+		/**
+		* @brief Collects the query and rebuilds the index, the query is opened on the first call
+		* @function refresh
+		* @returns {bool} true if the index is up to date, false otherwise
+		*/
+		bool refresh();
+
+		/**
+		* @brief Adds a wildcard Process counter collected with the index
+		* @function addCounter
+		* @param {std::string} counterName - The english name of the counter (e.g. IO Read Bytes/sec)
+		* @returns {int} the id of the counter, -1 if it could not be added
+		*/
+		int addCounter(const std::string& counterName);
+
+		/**
+		* @brief Gets the value of an added counter for a process as of the last refresh
+		* @function getValue
+		* @param {int} pid - The pid of the process
+		* @param {int} counterId - The id returned by addCounter
+		* @param {double} value - A reference where the value will be stored
+		* @returns {bool} true if the value is valid, false otherwise (rates need two refreshes)
+		*/
+		bool getValue(int pid, int counterId, double& value) const;
+
+	private:
+
+		/**
+		* @struct WildcardCounter
+		* @brief A wildcard counter and its values aligned with the instances of the index
+		*/
+		struct WildcardCounter
+		{
+			PDH_HCOUNTER handle;
+			std::vector<BYTE> buffer;
+			std::vector<double> values;
+			std::vector<bool> valid;
+		};
+
+		/**
+		* @brief Reads the formatted array of an added counter
+		* @param {WildcardCounter} counter - The counter to read
+		* @param {DWORD} itemCount - The number of instances of the pid array
+		*/
+		void readCounter(WildcardCounter& counter, DWORD itemCount);
+
+		/**
+		* @brief Opens the query and adds the wildcard counter
+		* @returns {bool} true if the query is ready, false otherwise
+		*/
+		bool open();
+
+		/**
+		* @var {PDH_HQUERY} query
+		* @brief The long-lived query
+		*/
+		PDH_HQUERY query = nullptr;
+
+		/**
+		* @var {PDH_HCOUNTER} pidCounter
+		* @brief The wildcard "ID Process" counter
+		*/
+		PDH_HCOUNTER pidCounter = nullptr;
+
+		/**
+		* @var {std::vector<BYTE>} buffer
+		* @brief The raw counter array, kept between refreshes
+		*/
+		std::vector<BYTE> buffer;
+
+		/**
+		* @var {std::unordered_map<int, DWORD>} positions
+		* @brief The position of every pid in the arrays of the last collection
+		*/
+		std::unordered_map<int, DWORD> positions;
+
+		/**
+		* @var {std::vector<WildcardCounter>} counters
+		* @brief The counters added to the query, indexed by their id
+		*/
+		std::vector<WildcardCounter> counters;
+};
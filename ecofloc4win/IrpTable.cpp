@@ -0,0 +1,159 @@
+/**
+ * @file IrpTable.cpp
+ * @brief Definition of the table of the disk requests in flight.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "IrpTable.h"
+
+#include <algorithm>
+
+IrpTable::IrpTable(size_t capacity, uint64_t timeout) : timeout(timeout)
+{
+	size_t size = 2;
+	while (size < capacity)
+	{
+		size <<= 1;
+	}
+
+	slots.assign(size, Entry{});
+	mask = size - 1;
+	expired.reserve(size);
+}
+
+size_t IrpTable::home(uint64_t irp) const
+{
+	// The addresses are aligned, mix the high bits into the low ones
+	irp ^= irp >> 33;
+	irp *= 0xff51afd7ed558ccdULL;
+	irp ^= irp >> 33;
+	return static_cast<size_t>(irp) & mask;
+}
+
+bool IrpTable::insert(const Entry& entry)
+{
+	if (entry.irp == 0)
+	{
+		return false;
+	}
+
+	// Sweep once every quarter of the capacity, or every 1/64 of it while the table is full, and only
+	// when a request can have expired so that a table full of live requests is not swept on each insert
+	uint64_t limit = entry.issuedAt > timeout ? entry.issuedAt - timeout : 0;
+	insertsSinceSweep++;
+	bool due = insertsSinceSweep > slots.size() / 4 || (count >= slots.size() - 1 && insertsSinceSweep > slots.size() / 64);
+	if (due && limit > oldest)
+	{
+		evictOlderThan(limit);
+	}
+
+	// Keep a free slot so that every probe ends
+	if (count >= slots.size() - 1)
+	{
+		return false;
+	}
+
+	size_t slot = home(entry.irp);
+	while (slots[slot].irp != 0 && slots[slot].irp != entry.irp)
+	{
+		slot = (slot + 1) & mask;
+	}
+
+	// A reused address means the completion of the previous request was lost
+	if (slots[slot].irp == 0)
+	{
+		count++;
+	}
+
+	slots[slot] = entry;
+	oldest = std::min(oldest, entry.issuedAt);
+	return true;
+}
+
+bool IrpTable::take(uint64_t irp, Entry& entry)
+{
+	if (irp == 0)
+	{
+		return false;
+	}
+
+	size_t slot = home(irp);
+	while (slots[slot].irp != 0)
+	{
+		if (slots[slot].irp == irp)
+		{
+			entry = slots[slot];
+			erase(slot);
+			return true;
+		}
+
+		slot = (slot + 1) & mask;
+	}
+
+	return false;
+}
+
+void IrpTable::erase(size_t slot)
+{
+	size_t next = slot;
+	while (true)
+	{
+		next = (next + 1) & mask;
+		if (slots[next].irp == 0)
+		{
+			break;
+		}
+
+		// The entry stays if its home is cyclically between the hole and its own slot
+		size_t target = home(slots[next].irp);
+		bool reachable = slot <= next ? (slot < target && target <= next) : (slot < target || target <= next);
+		if (reachable)
+		{
+			continue;
+		}
+
+		slots[slot] = slots[next];
+		slot = next;
+	}
+
+	slots[slot] = Entry{};
+	count--;
+}
+
+size_t IrpTable::evictOlderThan(uint64_t limit)
+{
+	insertsSinceSweep = 0;
+
+	expired.clear();
+	oldest = UINT64_MAX;
+	for (const Entry& entry : slots)
+	{
+		if (entry.irp == 0)
+		{
+			continue;
+		}
+
+		if (entry.issuedAt < limit)
+		{
+			expired.push_back(entry.irp);
+		}
+		else
+		{
+			oldest = std::min(oldest, entry.issuedAt);
+		}
+	}
+
+	Entry entry;
+	for (uint64_t irp : expired)
+	{
+		take(irp, entry);
+	}
+
+	return expired.size();
+}
+
+size_t IrpTable::size() const
+{
+	return count;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file IrpTable.h
+ * @brief Implementation of the table of the disk requests in flight.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class IrpTable
+ * @brief Fixed-capacity open-addressing table of the disk requests (IRP) waiting for their completion.
+ *
+ * The table never allocates after its construction: entries are stored inline, probed linearly and
+ * removed with backward shifting so no tombstone is left behind. Requests whose completion was never
+ * seen (the trace lost it) are evicted once they are older than the timeout, so the table stays bounded.
+ * The eviction sweeps the whole table, it only runs once every quarter of the capacity inserted (every
+ * 1/64 while the table is full) and never before the oldest request kept can have expired. It is only meant to be used by one thread.
+ */
+class IrpTable
+{
+	public:
+
+		/**
+		* @struct Entry
+		* @brief A request in flight, an irp of 0 marks a free slot
+		*/
+		struct Entry
+		{
+			uint64_t irp;
+			uint64_t issuedAt;
+			uint32_t pid;
+			uint32_t bytesTransferred;
+			uint16_t operationType;
+		};
+
+		/**
+		* @brief Builds an empty table
+		*
+		* @param {size_t} capacity - The number of slots, rounded up to a power of two
+		* @param {uint64_t} timeout - The age after which a request is evicted, in the unit of the timestamps
+		*/
+		IrpTable(size_t capacity, uint64_t timeout);
+
+		/**
+		* @brief Adds a request, evicting the expired ones first when the table fills up
+		* @function insert
+		* @param {Entry} entry - The request, its issuedAt is taken as the current time
+		* @returns {bool} true if the request was added, false if the table is full
+		*/
+		bool insert(const Entry& entry);
+
+		/**
+		* @brief Removes a request and returns it
+		* @function take
+		* @param {uint64_t} irp - The address of the request
+		* @param {Entry} entry - A reference where the request will be stored
+		* @returns {bool} true if the request was in the table, false otherwise
+		*/
+		bool take(uint64_t irp, Entry& entry);
+
+		/**
+		* @brief Evicts every request issued before a given time
+		* @function evictOlderThan
+		* @param {uint64_t} limit - The oldest time kept
+		* @returns {size_t} the number of evicted requests
+		*/
+		size_t evictOlderThan(uint64_t limit);
+
+		/**
+		* @brief Gets the number of requests in flight
+		* @function size
+		* @returns {size_t} the number of requests
+		*/
+		size_t size() const;
+
+	private:
+
+		/**
+		* @brief Gets the first slot to probe for a request
+		* @param {uint64_t} irp - The address of the request
+		* @returns {size_t} the home slot of the request
+		*/
+		size_t home(uint64_t irp) const;
+
+		/**
+		* @brief Frees a slot and shifts back the entries probed after it
+		* @param {size_t} slot - The slot to free
+		*/
+		void erase(size_t slot);
+
+		/**
+		* @var {std::vector<Entry>} slots
+		* @brief The entries, indexed by their probe position
+		*/
+		std::vector<Entry> slots;
+
+		/**
+		* @var {size_t} mask
+		* @brief The capacity minus one, used to wrap the probes
+		*/
+		size_t mask;
+
+		/**
+		* @var {size_t} count
+		* @brief The number of requests in flight
+		*/
+		size_t count = 0;
+
+		/**
+		* @var {uint64_t} timeout
+		* @brief The age after which a request is evicted
+		*/
+		uint64_t timeout;
+
+		/**
+		* @var {size_t} insertsSinceSweep
+		* @brief The number of requests added since the last eviction sweep
+		*/
+		size_t insertsSinceSweep = 0;
+
+		/**
+		* @var {uint64_t} oldest
+		* @brief No request in the table was issued before it, UINT64_MAX when the table was swept empty
+		*/
+		uint64_t oldest = UINT64_MAX;
+
+		/**
+		* @var {std::vector<uint64_t>} expired
+		* @brief The requests found by a sweep, kept to avoid allocating at each sweep
+		*/
+		std::vector<uint64_t> expired;
+};
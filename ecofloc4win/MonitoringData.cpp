@@ -8,6 +8,7 @@
 #include "MonitoringData.h"
 #include "Utils.h"
 
+#include <algorithm>
 #include <unordered_map>
 #include <stdexcept>
 
@@ -29,16 +30,53 @@ Utils::ComponentType stringToComponentType(const std::string& str)
 	throw std::invalid_argument("Invalid component type: " + str);
 }
 
+/**
+ * @brief Adds to a counter, safe against the other threads adding to it
+ * @function addTo
+ * @param {std::atomic<double>} counter - The counter
+ * @param {double} value - The value to add
+ */
+static void addTo(std::atomic<double>& counter, double value)
+{
+	double current = counter.load(std::memory_order_relaxed);
+	while (!counter.compare_exchange_weak(current, current + value, std::memory_order_relaxed))
+	{
+	}
+}
+
+MonitoringData::Counters::Counters(size_t pidCount) : gpuDeviceCount(0), pidsCPUEnergy(new std::atomic<double>[pidCount])
+{
+	for (size_t i = 0; i < MAX_GPU_DEVICES; i++)
+	{
+		gpuDevicesEnergy[i].store(0.0, std::memory_order_relaxed);
+	}
+
+	for (size_t i = 0; i < pidCount; i++)
+	{
+		pidsCPUEnergy[i].store(0.0, std::memory_order_relaxed);
+	}
+}
+
 std::string MonitoringData::getName() const
 {
 	return name;
 }
 
-std::vector<int> MonitoringData::getPids() const
+const std::vector<int>& MonitoringData::getPids() const
 {
 	return pids;
 }
 
+AppId MonitoringData::getId() const
+{
+	return id;
+}
+
+void MonitoringData::setId(AppId appId)
+{
+	id = appId;
+}
+
 void MonitoringData::enableComponent(const std::string& componentStr)
 {
 	Utils::ComponentType component = stringToComponentType(componentStr);
@@ -100,56 +138,47 @@ bool MonitoringData::isNICEnabled() const
 	return nicEnabled;
 }
 
-double MonitoringData::getCPUEnergy() const
+std::vector<double> MonitoringData::getGPUDevicesEnergy() const
 {
-	return cpuEnergy;
-}
-
-double MonitoringData::getGPUEnergy() const
-{
-	return gpuEnergy;
-}
-
-double MonitoringData::getSDEnergy() const
-{
-	return sdEnergy;
-}
+	std::vector<double> energies(counters->gpuDeviceCount.load(std::memory_order_relaxed));
+	for (size_t i = 0; i < energies.size(); i++)
+	{
+		energies[i] = counters->gpuDevicesEnergy[i].load(std::memory_order_relaxed);
+	}
 
-double MonitoringData::getNICEnergy() const
-{
-	return nicEnergy;
+	return energies;
 }
 
-void MonitoringData::updateCPUEnergy(double energy)
+std::vector<double> MonitoringData::getPidsCPUEnergy() const
 {
-	cpuEnergy += energy;
-}
+	std::vector<double> energies(pids.size());
+	for (size_t i = 0; i < energies.size(); i++)
+	{
+		energies[i] = counters->pidsCPUEnergy[i].load(std::memory_order_relaxed);
+	}
 
-void MonitoringData::updateGPUEnergy(double energy)
-{
-	gpuEnergy += energy;
+	return energies;
 }
 
-void MonitoringData::updateSDEnergy(double energy)
+void MonitoringData::updatePidsCPUEnergy(const double* energies) const
 {
-	sdEnergy += energy;
+	for (size_t i = 0; i < pids.size(); i++)
+	{
+		addTo(counters->pidsCPUEnergy[i], energies[i]);
+	}
 }
 
-void MonitoringData::updateNICEnergy(double energy)
+void MonitoringData::updateGPUDevicesEnergy(const std::vector<double>& energies) const
 {
-	nicEnergy += energy;
-}
-
-void MonitoringData::addIrp(ULONGLONG irpAddress, const IoEventInfo& info) {
-	irpMap[irpAddress] = info;
-}
-
-void MonitoringData::updateIrp(ULONGLONG irpAddress, ULONG bytesTransferred) {
-	if (irpMap.find(irpAddress) != irpMap.end()) {
-		irpMap[irpAddress].bytesTransferred += bytesTransferred;
+	size_t deviceCount = std::min(energies.size(), MAX_GPU_DEVICES);
+	for (size_t i = 0; i < deviceCount; i++)
+	{
+		addTo(counters->gpuDevicesEnergy[i], energies[i]);
 	}
-}
 
-void MonitoringData::removeIrp(ULONGLONG irpAddress) {
-	irpMap.erase(irpAddress);
+	// Only grows, the devices are read up to the count once their energy is stored
+	size_t knownCount = counters->gpuDeviceCount.load(std::memory_order_relaxed);
+	while (knownCount < deviceCount && !counters->gpuDeviceCount.compare_exchange_weak(knownCount, deviceCount, std::memory_order_relaxed))
+	{
+	}
 }
\ No newline at end of file
@@ -7,17 +7,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <string>
 #include <windows.h>
-#include <map>
 
-struct IoEventInfo {
-	DWORD pid;
-	std::wstring processName;
-	USHORT operationType;
-	ULONG bytesTransferred = 0;  // Track total bytes transferred for each IRP
-};
+#include "AppSlots.h"
 
 /**
  * @class MonitoringData
@@ -25,11 +21,36 @@ struct IoEventInfo {
  *
  * This class provides functionalities to enable and disable any component to work on the process
  * and update the energy used by each active component for the process and also get the total used
+ *
+ * The name, pids and enabled components are plain values copied with the application. The energy of
+ * each pid and of each GPU are atomic counters shared by every copy, the totals and powers of each
+ * component are kept in the EnergyLedger.
  */
 class MonitoringData
 {
+	public:
+
+		/**
+		* @var {size_t} MAX_GPU_DEVICES
+		* @brief the number of GPUs whose energy is detailed, the energy of the others only goes to the total
+		*/
+		static constexpr size_t MAX_GPU_DEVICES = 8;
+
 	private:
 
+		/**
+		* @struct Counters
+		* @brief The detailed energies of the application, updated in place by the samplers
+		*/
+		struct Counters
+		{
+			explicit Counters(size_t pidCount);
+
+			std::atomic<double> gpuDevicesEnergy[MAX_GPU_DEVICES];
+			std::atomic<size_t> gpuDeviceCount;
+			std::unique_ptr<std::atomic<double>[]> pidsCPUEnergy;
+		};
+
 		/**
 		* @var {std::string} name
 		* @brief the name of the process
@@ -41,12 +62,12 @@ class MonitoringData
 		* @brief the pids of the process
 		*/
 		std::vector<int> pids;
-		
+
 		/**
-		* @var {std::map<ULONGLONG, IoEventInfo>} irpMap
-		* @brief 
+		* @var {AppId} id
+		* @brief the stable identifier of the process, given when it is added to the monitored list
 		*/
-		std::map<ULONGLONG, IoEventInfo> irpMap;
+		AppId id;
 
 		/**
 		* @var {bool} cpuEnabled
@@ -73,28 +94,10 @@ class MonitoringData
 		bool nicEnabled = false;
 
 		/**
-		* @var {double} cpuEnergy
-		* @brief the total energy used by cpu for this process
-		*/
-		double cpuEnergy = 0.0;
-
-		/**
-		* @var {double} gpuEnergy
-		* @brief the total energy used by gpu for this process
-		*/
-		double gpuEnergy = 0.0;
-
-		/**
-		* @var {double} sdEnergy
-		* @brief the total energy used by sd for this process
-		*/
-		double sdEnergy = 0.0;
-
-		/**
-		* @var {double} nicEnergy
-		* @brief the total energy used by nic for this process
+		* @var {std::shared_ptr<Counters>} counters
+		* @brief the detailed energies of the process, shared by every copy of it
 		*/
-		double nicEnergy = 0.0;
+		std::shared_ptr<Counters> counters;
 
 	public:
 
@@ -104,7 +107,7 @@ class MonitoringData
 		* @param {std::string} appName - the name of the process
 		* @param {std::vector<int>} pids - the list of pids of the process 
 		*/
-		MonitoringData(const std::string& appName = "", const std::vector<int>& pids = {}) : name(appName), pids(pids) {}
+		MonitoringData(const std::string& appName = "", const std::vector<int>& pids = {}) : name(appName), pids(pids), counters(std::make_shared<Counters>(pids.size())) {}
 
 		/**
 		* @brief Gets the name of the process
@@ -118,7 +121,21 @@ class MonitoringData
 		* @function getPids
 		* @returns {std::vector<int>} of int list of the pids of the process
 		*/
-		std::vector<int> getPids() const;
+		const std::vector<int>& getPids() const;
+
+		/**
+		* @brief Gets the stable identifier of the process
+		* @function getId
+		* @returns {AppId} the identifier given when the process was added to the monitored list
+		*/
+		AppId getId() const;
+
+		/**
+		* @brief Sets the stable identifier of the process
+		* @function setId
+		* @param {AppId} appId - the identifier given by the monitored list
+		*/
+		void setId(AppId appId);
 
 		/**
 		* @brief Enables the chosen component for the monitoring of this process
@@ -163,64 +180,31 @@ class MonitoringData
 		bool isNICEnabled() const;
 
 		/**
-		* @brief Gets the energy used by the CPU for this process
-		* @function getCPUEnergy
-		* @returns {double} the energy in Joules used by the CPU for this process
-		*/
-		double getCPUEnergy() const;
-
-		/**
-		* @brief Gets the energy used by the GPU for this process
-		* @function getGPUEnergy
-		* @returns {double} the energy in Joules used by the GPU for this process
-		*/
-		double getGPUEnergy() const;
-
-		/**
-		* @brief Gets the energy used by the SD for this process
-		* @function getSDEnergy
-		* @returns {double} the energy in Joules used by the SD for this process
-		*/
-		double getSDEnergy() const;
-
-		/**
-		* @brief Gets the energy used by the NIC for this process
-		* @function getNICEnergy
-		* @returns {double} the energy in Joules used by the NIC for this process
+		* @brief Gets the energy used on each GPU for this process
+		* @function getGPUDevicesEnergy
+		* @returns {std::vector<double>} the energy in Joules used on each GPU, in the order of the NVML indices
 		*/
-		double getNICEnergy() const;
+		std::vector<double> getGPUDevicesEnergy() const;
 
 		/**
-		* @brief Updates energy used by the CPU for this process by adding the current energy with the last enregy calculated
-		* @function updateCPUEnergy
-		* @param {double} energy - the last energy calculated 
+		* @brief Gets the energy used by the CPU for each pid of this process
+		* @function getPidsCPUEnergy
+		* @returns {std::vector<double>} the energy in Joules used by each pid, in the order of getPids
 		*/
-		void updateCPUEnergy(double energy);
+		std::vector<double> getPidsCPUEnergy() const;
 
 		/**
-		* @brief Updates energy used by the GPU for this process by adding the current energy with the last enregy calculated
-		* @function updateGPUEnergy
-		* @param {double} energy - the last energy calculated 
+		* @brief Updates energy used by the CPU for each pid of this process by adding the last energy calculated
+		* @function updatePidsCPUEnergy
+		* @param {const double*} energies - the last energy calculated for each pid, in the order of getPids
 		*/
-		void updateGPUEnergy(double energy);
+		void updatePidsCPUEnergy(const double* energies) const;
 
 		/**
-		* @brief Updates energy used by the SD for this process by adding the current energy with the last enregy calculated
-		* @function updateSDEnergy
-		* @param {double} energy - the last energy calculated 
+		* @brief Updates energy used on each GPU for this process by adding the last energy calculated
+		* @function updateGPUDevicesEnergy
+		* @param {std::vector<double>} energies - the last energy calculated on each GPU, in the order of the NVML indices
 		*/
-		void updateSDEnergy(double energy);
-
-		/**
-		* @brief Updates energy used by the NIC for this process by adding the current energy with the last enregy calculated
-		* @function updateNICEnergy
-		* @param {double} energy - the last energy calculated 
-		*/
-		void updateNICEnergy(double energy);
-
-
-		void addIrp(ULONGLONG irpAddress, const IoEventInfo& info);
-		void updateIrp(ULONGLONG irpAddress, ULONG bytesTransferred);
-		void removeIrp(ULONGLONG irpAddress);
+		void updateGPUDevicesEnergy(const std::vector<double>& energies) const;
 };
 
@@ -0,0 +1,272 @@
+/**
+ * @file NetworkTracer.cpp
+ * @brief Definition of the event-driven network accounting.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "NetworkTracer.h"
+
+#include <cstring>
+#include <iostream>
+
+NetworkTracer::NetworkTracer() : counters(RELEASE_DELAY)
+{
+}
+
+NetworkTracer::~NetworkTracer()
+{
+	stop();
+}
+
+void NetworkTracer::onEvent(const Event& event)
+{
+	counters.releaseEnded(event.timestamp);
+
+	switch (event.type)
+	{
+	case EventType::ProcessStart:
+		// The pid may be reused, what is left belongs to the previous process, most processes never use the network
+		counters.restart(event.pid);
+		break;
+
+	case EventType::ProcessEnd:
+		// The slot is kept a while for the last take of the sampler
+		counters.end(event.pid, event.timestamp);
+		break;
+
+	case EventType::Send:
+	case EventType::Receive:
+	{
+		// The System process and unknown owners can not be attributed
+		if (event.pid == 0 || event.pid == UINT32_MAX)
+		{
+			break;
+		}
+
+		if (!counters.add(event.pid, event.type == EventType::Send ? 0 : 1, event.size))
+		{
+			droppedEvents.fetch_add(1, std::memory_order_relaxed);
+		}
+		break;
+	}
+	}
+}
+
+void NetworkTracer::replay(const std::vector<Event>& events)
+{
+	for (const Event& event : events)
+	{
+		onEvent(event);
+	}
+}
+
+bool NetworkTracer::takeBytes(int pid, uint64_t& sentBytes, uint64_t& receivedBytes)
+{
+	return counters.take(static_cast<uint32_t>(pid), sentBytes, receivedBytes);
+}
+
+uint64_t NetworkTracer::getDroppedEvents() const
+{
+	return droppedEvents.load(std::memory_order_relaxed);
+}
+
+size_t NetworkTracer::getTrackedProcesses() const
+{
+	return counters.getTrackedProcesses();
+}
+
+#ifdef _WIN32
+
+/**
+ * @brief Defines the Microsoft-Windows-Kernel-Network and Kernel-Process providers and the events used here
+ * @{
+ */
+static const GUID KERNEL_NETWORK_GUID = { 0x7dd42a49, 0x5329, 0x4832, { 0x8d, 0xfd, 0x43, 0xd9, 0x79, 0x15, 0x3a, 0x88 } };
+static const GUID KERNEL_PROCESS_GUID = { 0x22fb2cd6, 0x0e7b, 0x422b, { 0xa0, 0xc7, 0x2f, 0xad, 0x1f, 0xd0, 0xe7, 0x16 } };
+static const wchar_t* SESSION_NAME = L"Ecofloc Network Trace";
+
+#define KERNEL_NETWORK_KEYWORD_IPV4 0x10
+#define KERNEL_NETWORK_KEYWORD_IPV6 0x20
+#define KERNEL_PROCESS_KEYWORD_PROCESS 0x10
+
+#define PROCESS_START 1
+#define PROCESS_STOP 2
+
+#define TCPV4_SEND 10
+#define TCPV4_RECEIVE 11
+#define TCPV6_SEND 26
+#define TCPV6_RECEIVE 27
+#define UDPV4_SEND 42
+#define UDPV4_RECEIVE 43
+#define UDPV6_SEND 58
+#define UDPV6_RECEIVE 59
+/**
+ * @}
+ */
+
+void WINAPI NetworkTracer::onEventRecord(PEVENT_RECORD record)
+{
+	const BYTE* data = static_cast<const BYTE*>(record->UserData);
+	Event event = {};
+	event.timestamp = static_cast<uint64_t>(record->EventHeader.TimeStamp.QuadPart);
+
+	if (IsEqualGUID(record->EventHeader.ProviderId, KERNEL_PROCESS_GUID))
+	{
+		// ProcessID, CreateTime, ...: the pid comes first in both events
+		USHORT id = record->EventHeader.EventDescriptor.Id;
+		if ((id != PROCESS_START && id != PROCESS_STOP) || record->UserDataLength < sizeof(uint32_t))
+		{
+			return;
+		}
+
+		event.type = id == PROCESS_START ? EventType::ProcessStart : EventType::ProcessEnd;
+		std::memcpy(&event.pid, data, sizeof(event.pid));
+		static_cast<NetworkTracer*>(record->UserContext)->onEvent(event);
+		return;
+	}
+
+	if (!IsEqualGUID(record->EventHeader.ProviderId, KERNEL_NETWORK_GUID))
+	{
+		return;
+	}
+
+	switch (record->EventHeader.EventDescriptor.Id)
+	{
+	case TCPV4_SEND:
+	case TCPV6_SEND:
+	case UDPV4_SEND:
+	case UDPV6_SEND:
+		event.type = EventType::Send;
+		break;
+
+	case TCPV4_RECEIVE:
+	case TCPV6_RECEIVE:
+	case UDPV4_RECEIVE:
+	case UDPV6_RECEIVE:
+		event.type = EventType::Receive;
+		break;
+
+	default:
+		return;
+	}
+
+	// PID, size, then the addresses: the header pid is the one of the context the event was logged in
+	if (record->UserDataLength < 2 * sizeof(uint32_t))
+	{
+		return;
+	}
+
+	std::memcpy(&event.pid, data, sizeof(event.pid));
+	std::memcpy(&event.size, data + sizeof(uint32_t), sizeof(event.size));
+
+	static_cast<NetworkTracer*>(record->UserContext)->onEvent(event);
+}
+
+bool NetworkTracer::start()
+{
+	if (consumer.joinable())
+	{
+		return true;
+	}
+
+	size_t nameSize = (wcslen(SESSION_NAME) + 1) * sizeof(wchar_t);
+	properties.assign(sizeof(EVENT_TRACE_PROPERTIES) + nameSize, 0);
+	EVENT_TRACE_PROPERTIES* props = reinterpret_cast<EVENT_TRACE_PROPERTIES*>(properties.data());
+	props->Wnode.BufferSize = static_cast<ULONG>(properties.size());
+	props->Wnode.ClientContext = 2; // System time timestamps, in 100ns units
+	props->Wnode.Flags = WNODE_FLAG_TRACED_GUID;
+	props->LogFileMode = EVENT_TRACE_REAL_TIME_MODE;
+	props->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+
+	ULONG status = StartTrace(&sessionHandle, SESSION_NAME, props);
+	if (status == ERROR_ALREADY_EXISTS)
+	{
+		// Take the session over from a previous run that did not stop it
+		ControlTrace(0, SESSION_NAME, props, EVENT_TRACE_CONTROL_STOP);
+		props->Wnode.BufferSize = static_cast<ULONG>(properties.size());
+		props->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+		status = StartTrace(&sessionHandle, SESSION_NAME, props);
+	}
+
+	if (status != ERROR_SUCCESS)
+	{
+		std::cerr << "Failed to start the network trace session. Error: " << status << std::endl;
+		sessionHandle = 0;
+		return false;
+	}
+
+	status = EnableTraceEx2(sessionHandle, &KERNEL_NETWORK_GUID, EVENT_CONTROL_CODE_ENABLE_PROVIDER, TRACE_LEVEL_INFORMATION,
+		KERNEL_NETWORK_KEYWORD_IPV4 | KERNEL_NETWORK_KEYWORD_IPV6, 0, 0, nullptr);
+	if (status != ERROR_SUCCESS)
+	{
+		std::cerr << "Failed to enable the Kernel-Network provider. Error: " << status << std::endl;
+		stop();
+		return false;
+	}
+
+	status = EnableTraceEx2(sessionHandle, &KERNEL_PROCESS_GUID, EVENT_CONTROL_CODE_ENABLE_PROVIDER, TRACE_LEVEL_INFORMATION,
+		KERNEL_PROCESS_KEYWORD_PROCESS, 0, 0, nullptr);
+	if (status != ERROR_SUCCESS)
+	{
+		std::cerr << "Failed to enable the Kernel-Process provider. Error: " << status << std::endl;
+		stop();
+		return false;
+	}
+
+	EVENT_TRACE_LOGFILE logFile = {};
+	logFile.LoggerName = const_cast<LPWSTR>(SESSION_NAME);
+	logFile.ProcessTraceMode = PROCESS_TRACE_MODE_REAL_TIME | PROCESS_TRACE_MODE_EVENT_RECORD;
+	logFile.EventRecordCallback = onEventRecord;
+	logFile.Context = this;
+
+	traceHandle = OpenTrace(&logFile);
+	if (traceHandle == INVALID_PROCESSTRACE_HANDLE)
+	{
+		std::cerr << "Failed to open the network trace. Error: " << GetLastError() << std::endl;
+		stop();
+		return false;
+	}
+
+	consumer = std::thread([this]
+	{
+		// Blocks until the session is stopped
+		ProcessTrace(&traceHandle, 1, nullptr, nullptr);
+	});
+
+	return true;
+}
+
+void NetworkTracer::stop()
+{
+	if (sessionHandle != 0)
+	{
+		EVENT_TRACE_PROPERTIES* props = reinterpret_cast<EVENT_TRACE_PROPERTIES*>(properties.data());
+		ControlTrace(sessionHandle, SESSION_NAME, props, EVENT_TRACE_CONTROL_STOP);
+		sessionHandle = 0;
+	}
+
+	if (traceHandle != INVALID_PROCESSTRACE_HANDLE)
+	{
+		CloseTrace(traceHandle);
+		traceHandle = INVALID_PROCESSTRACE_HANDLE;
+	}
+
+	if (consumer.joinable())
+	{
+		consumer.join();
+	}
+}
+
+#else
+
+bool NetworkTracer::start()
+{
+	return false;
+}
+
+void NetworkTracer::stop()
+{
+}
+
+#endif
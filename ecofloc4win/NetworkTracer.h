@@ -0,0 +1,180 @@
+/**
+ * @file NetworkTracer.h
+ * @brief Implementation of the event-driven network accounting.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "PidByteCounters.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <evntrace.h>
+#include <evntcons.h>
+#endif
+
+/**
+ * @class NetworkTracer
+ * @brief Counts the bytes sent and received by every process from the Microsoft-Windows-Kernel-Network events.
+ *
+ * The provider reports every TCP and UDP send and receive over IPv4 and IPv6 with the pid of the owner
+ * and the size of the transfer, so QUIC and the connections GetExtendedTcpTable does not list are counted too.
+ * The bytes go to per-pid atomic counters that the sampler drains at its own pace without locking the
+ * event thread. The Microsoft-Windows-Kernel-Process events of the same session reset the counters of
+ * a pid when Windows reuses it and give the slot of an ended process back once the sampler had time to
+ * take its last bytes.
+ *
+ * On Windows the events come from a real-time trace session (administrator rights required);
+ * anywhere the events can also be fed with replay, which makes the accounting testable off-Windows.
+ */
+class NetworkTracer
+{
+	public:
+
+		/**
+		* @enum EventType
+		* @brief The kernel events used by the accounting
+		*/
+		enum class EventType : uint8_t
+		{
+			Send,
+			Receive,
+			ProcessStart,
+			ProcessEnd
+		};
+
+		/**
+		* @struct Event
+		* @brief A decoded event, the size is only meaningful for the Send and Receive events
+		*/
+		struct Event
+		{
+			EventType type;
+			uint32_t pid;
+			uint32_t size;
+			uint64_t timestamp;
+		};
+
+		/**
+		* @var {size_t} PID_CAPACITY
+		* @brief The number of processes the counters can hold, a power of two
+		*/
+		static constexpr size_t PID_CAPACITY = PidByteCounters::CAPACITY;
+
+		/**
+		* @var {uint64_t} RELEASE_DELAY
+		* @brief The time the counters of an ended process are kept for the last take of the sampler,
+		*        in 100ns units (10 s)
+		*/
+		static constexpr uint64_t RELEASE_DELAY = 100000000;
+
+		NetworkTracer();
+		~NetworkTracer();
+
+		NetworkTracer(const NetworkTracer&) = delete;
+		NetworkTracer& operator=(const NetworkTracer&) = delete;
+
+		/**
+		* @brief Starts the real-time trace session and its consumer thread
+		* @function start
+		* @returns {bool} true if the events are flowing, false otherwise (always false off-Windows)
+		*/
+		bool start();
+
+		/**
+		* @brief Stops the trace session and joins its consumer thread
+		* @function stop
+		*/
+		void stop();
+
+		/**
+		* @brief Accounts one event, must always be called from the same thread
+		* @function onEvent
+		* @param {Event} event - The decoded event
+		*/
+		void onEvent(const Event& event);
+
+		/**
+		* @brief Accounts a recorded stream of events as if they came from the trace session
+		* @function replay
+		* @param {std::vector<Event>} events - The events in the order they were emitted
+		*/
+		void replay(const std::vector<Event>& events);
+
+		/**
+		* @brief Takes the bytes transferred by a process since the previous call
+		* @function takeBytes
+		* @param {int} pid - The pid of the process
+		* @param {uint64_t} sentBytes - A reference where the bytes sent will be stored
+		* @param {uint64_t} receivedBytes - A reference where the bytes received will be stored
+		* @returns {bool} true if the process used the network since the trace started, false otherwise
+		*/
+		bool takeBytes(int pid, uint64_t& sentBytes, uint64_t& receivedBytes);
+
+		/**
+		* @brief Gets the number of events that could not be accounted because the counters are full
+		* @function getDroppedEvents
+		* @returns {uint64_t} the number of dropped events
+		*/
+		uint64_t getDroppedEvents() const;
+
+		/**
+		* @brief Gets the number of processes holding counters, ended ones included until they are released
+		* @function getTrackedProcesses
+		* @returns {size_t} the number of processes
+		*/
+		size_t getTrackedProcesses() const;
+
+	private:
+
+		/**
+		* @var {PidByteCounters} counters
+		* @brief The bytes of each process, the counter 0 for the bytes sent and 1 for the bytes received
+		*/
+		PidByteCounters counters;
+
+		/**
+		* @var {std::atomic<uint64_t>} droppedEvents
+		* @brief The events lost because the counters are full
+		*/
+		std::atomic<uint64_t> droppedEvents{ 0 };
+
+#ifdef _WIN32
+		/**
+		* @brief Decodes a Kernel-Network or Kernel-Process event and accounts it
+		* @param {PEVENT_RECORD} record - The event delivered by ProcessTrace
+		*/
+		static void WINAPI onEventRecord(PEVENT_RECORD record);
+
+		/**
+		* @var {std::vector<BYTE>} properties
+		* @brief The properties of the session followed by its name
+		*/
+		std::vector<BYTE> properties;
+
+		/**
+		* @var {TRACEHANDLE} sessionHandle
+		* @brief The handle of the controlled session
+		*/
+		TRACEHANDLE sessionHandle = 0;
+
+		/**
+		* @var {TRACEHANDLE} traceHandle
+		* @brief The handle of the consumed trace
+		*/
+		TRACEHANDLE traceHandle = INVALID_PROCESSTRACE_HANDLE;
+#endif
+
+		/**
+		* @var {std::thread} consumer
+		* @brief The thread delivering the events
+		*/
+		std::thread consumer;
+};
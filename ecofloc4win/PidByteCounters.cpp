@@ -0,0 +1,291 @@
+/**
+ * @file PidByteCounters.cpp
+ * @brief Definition of the per-pid byte counters of the trace consumers.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "PidByteCounters.h"
+
+#include <algorithm>
+
+static_assert((PidByteCounters::CAPACITY & (PidByteCounters::CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+/**
+ * @brief Spreads the pids, which are multiples of 4 on Windows, over the table
+ * @function hashPid
+ * @param {uint32_t} pid - The pid to hash
+ * @returns {size_t} the first slot to probe
+ */
+static size_t hashPid(uint32_t pid)
+{
+	pid ^= pid >> 16;
+	pid *= 0x45d9f3b;
+	pid ^= pid >> 16;
+	return pid & (PidByteCounters::CAPACITY - 1);
+}
+
+PidByteCounters::PidByteCounters(uint64_t releaseDelay) : releaseDelay(releaseDelay), slots(new Slot[CAPACITY]), releases(new Release[CAPACITY])
+{
+}
+
+PidByteCounters::Slot* PidByteCounters::find(uint32_t pid)
+{
+	if (pid == 0 || pid == RELEASED)
+	{
+		return nullptr;
+	}
+
+	// A free slot ends the probe sequence of the pid, the released ones do not
+	size_t slot = hashPid(pid);
+	for (size_t probe = 0; probe < CAPACITY; probe++)
+	{
+		Slot& entry = slots[slot];
+		uint32_t current = entry.pid.load(std::memory_order_acquire);
+
+		if (current == pid)
+		{
+			return &entry;
+		}
+
+		if (current == 0)
+		{
+			return nullptr;
+		}
+
+		slot = (slot + 1) & (CAPACITY - 1);
+	}
+
+	return nullptr;
+}
+
+PidByteCounters::Slot* PidByteCounters::claim(uint32_t pid)
+{
+	if (pid == 0 || pid == RELEASED)
+	{
+		return nullptr;
+	}
+
+	// Only the event thread claims and releases, the pid is known to be absent once a free slot is reached
+	Slot* reusable = nullptr;
+	size_t slot = hashPid(pid);
+	for (size_t probe = 0; probe < CAPACITY; probe++)
+	{
+		Slot& entry = slots[slot];
+		uint32_t current = entry.pid.load(std::memory_order_relaxed);
+
+		if (current == pid)
+		{
+			return &entry;
+		}
+
+		if (current == RELEASED && !reusable)
+		{
+			reusable = &entry;
+		}
+
+		if (current == 0)
+		{
+			break;
+		}
+
+		slot = (slot + 1) & (CAPACITY - 1);
+	}
+
+	// Keep a free slot so that every probe ends
+	if (!reusable)
+	{
+		if (usedSlots >= CAPACITY - 1)
+		{
+			return nullptr;
+		}
+
+		reusable = &slots[slot];
+		usedSlots++;
+	}
+
+	// The counters are cleared before the pid is published, a reader finding the pid never sees the previous process
+	reusable->bytes[0].store(0, std::memory_order_relaxed);
+	reusable->bytes[1].store(0, std::memory_order_relaxed);
+	reusable->endedAt = 0;
+	reusable->pid.store(pid, std::memory_order_release);
+	trackedProcesses.fetch_add(1, std::memory_order_relaxed);
+	return reusable;
+}
+
+bool PidByteCounters::track(uint32_t pid)
+{
+	Slot* entry = claim(pid);
+	if (!entry)
+	{
+		return false;
+	}
+
+	// The pid may be reused, what is left belongs to the previous process
+	entry->bytes[0].store(0, std::memory_order_relaxed);
+	entry->bytes[1].store(0, std::memory_order_relaxed);
+	entry->endedAt = 0;
+	return true;
+}
+
+void PidByteCounters::restart(uint32_t pid)
+{
+	Slot* entry = find(pid);
+	if (entry)
+	{
+		entry->bytes[0].store(0, std::memory_order_relaxed);
+		entry->bytes[1].store(0, std::memory_order_relaxed);
+		entry->endedAt = 0;
+	}
+}
+
+void PidByteCounters::end(uint32_t pid, uint64_t now)
+{
+	Slot* entry = find(pid);
+	if (!entry || entry->endedAt != 0)
+	{
+		return;
+	}
+
+	entry->endedAt = std::max<uint64_t>(now, 1);
+	nextRelease = std::min(nextRelease, entry->endedAt + releaseDelay);
+
+	if (releaseCount == CAPACITY)
+	{
+		releasesLost = true;
+		return;
+	}
+
+	releases[(releaseHead + releaseCount) & (CAPACITY - 1)] = { static_cast<size_t>(entry - slots.get()), entry->endedAt };
+	releaseCount++;
+}
+
+bool PidByteCounters::add(uint32_t pid, size_t counter, uint64_t bytes)
+{
+	Slot* entry = claim(pid);
+	if (!entry)
+	{
+		return false;
+	}
+
+	entry->bytes[counter].fetch_add(bytes, std::memory_order_relaxed);
+	return true;
+}
+
+void PidByteCounters::release(size_t slot)
+{
+	slots[slot].pid.store(RELEASED, std::memory_order_release);
+	trackedProcesses.fetch_sub(1, std::memory_order_relaxed);
+
+	// A released slot followed by a free one ends no probe sequence, it is freed with the released ones before it
+	size_t last = slot;
+	if (slots[(last + 1) & (CAPACITY - 1)].pid.load(std::memory_order_relaxed) != 0)
+	{
+		return;
+	}
+
+	while (slots[last].pid.load(std::memory_order_relaxed) == RELEASED)
+	{
+		slots[last].pid.store(0, std::memory_order_release);
+		usedSlots--;
+		last = (last - 1) & (CAPACITY - 1);
+	}
+}
+
+void PidByteCounters::sweep(uint64_t now)
+{
+	releaseHead = 0;
+	releaseCount = 0;
+	releasesLost = false;
+
+	for (size_t slot = 0; slot < CAPACITY; slot++)
+	{
+		Slot& entry = slots[slot];
+		uint32_t pid = entry.pid.load(std::memory_order_relaxed);
+		if (pid == 0 || pid == RELEASED || entry.endedAt == 0)
+		{
+			continue;
+		}
+
+		if (entry.endedAt + releaseDelay > now)
+		{
+			releases[releaseCount++] = { slot, entry.endedAt };
+			continue;
+		}
+
+		release(slot);
+	}
+
+	// One slot is always free, every ended process fits in the ring
+	std::sort(releases.get(), releases.get() + releaseCount, [](const Release& a, const Release& b)
+	{
+		return a.endedAt < b.endedAt;
+	});
+	nextRelease = releaseCount > 0 ? releases[0].endedAt + releaseDelay : UINT64_MAX;
+}
+
+void PidByteCounters::releaseEnded(uint64_t now)
+{
+	if (now < nextRelease)
+	{
+		return;
+	}
+
+	if (releasesLost)
+	{
+		sweep(now);
+		return;
+	}
+
+	// The processes end in the order of the timestamps, the oldest ends are the first due
+	while (releaseCount > 0)
+	{
+		const Release& next = releases[releaseHead];
+		if (next.endedAt + releaseDelay > now)
+		{
+			break;
+		}
+
+		// The slot may have been restarted, or released and given to a process that ended later
+		Slot& entry = slots[next.slot];
+		uint32_t pid = entry.pid.load(std::memory_order_relaxed);
+		if (pid != 0 && pid != RELEASED && entry.endedAt == next.endedAt)
+		{
+			release(next.slot);
+		}
+
+		releaseHead = (releaseHead + 1) & (CAPACITY - 1);
+		releaseCount--;
+	}
+
+	nextRelease = releaseCount > 0 ? releases[releaseHead].endedAt + releaseDelay : UINT64_MAX;
+}
+
+bool PidByteCounters::take(uint32_t pid, uint64_t& first, uint64_t& second)
+{
+	Slot* entry = find(pid);
+	if (!entry)
+	{
+		return false;
+	}
+
+	first = entry->bytes[0].exchange(0, std::memory_order_relaxed);
+	second = entry->bytes[1].exchange(0, std::memory_order_relaxed);
+
+	// The slot was released and given to another process meanwhile, the bytes taken are its own
+	if (entry->pid.load(std::memory_order_acquire) != pid)
+	{
+		entry->bytes[0].fetch_add(first, std::memory_order_relaxed);
+		entry->bytes[1].fetch_add(second, std::memory_order_relaxed);
+		first = 0;
+		second = 0;
+		return false;
+	}
+
+	return true;
+}
+
+size_t PidByteCounters::getTrackedProcesses() const
+{
+	return trackedProcesses.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,214 @@
+/**
+ * @file PidByteCounters.h
+ * @brief Implementation of the per-pid byte counters of the trace consumers.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @class PidByteCounters
+ * @brief Fixed-capacity open-addressing table of two byte counters per process, filled by one event thread
+ *        and drained by the sampler without locking.
+ *
+ * Each process has two counters whose meaning is left to the tracer (read and written, sent and received).
+ * Only the event thread gives slots, adds bytes and ends processes; take may be called from any thread.
+ * The slot of an ended process is kept for the release delay so the sampler can take its last bytes, then
+ * given back: a released slot is reused by the next process probing past it and freed with the released
+ * slots before it once it ends no probe sequence. One slot always stays free so that every probe ends.
+ * The ended processes wait in a ring in the order they ended, so releasing one does not sweep the table;
+ * the table is only swept when more processes end within the delay than the ring holds.
+ */
+class PidByteCounters
+{
+	public:
+
+		/**
+		* @var {size_t} CAPACITY
+		* @brief The number of slots, a power of two, one of them always stays free
+		*/
+		static constexpr size_t CAPACITY = 4096;
+
+		/**
+		* @brief Builds an empty table
+		*
+		* @param {uint64_t} releaseDelay - The time the counters of an ended process are kept, in the unit of the timestamps
+		*/
+		explicit PidByteCounters(uint64_t releaseDelay);
+
+		PidByteCounters(const PidByteCounters&) = delete;
+		PidByteCounters& operator=(const PidByteCounters&) = delete;
+
+		/**
+		* @brief Gives a process empty counters, taking a slot if it has none
+		* @function track
+		* @param {uint32_t} pid - The pid of the process
+		* @returns {bool} true if the process has counters, false if the pid is 0 or the table is full
+		*/
+		bool track(uint32_t pid);
+
+		/**
+		* @brief Empties the counters of a process that has some, its pid was given to a new process
+		* @function restart
+		* @param {uint32_t} pid - The pid of the process
+		*/
+		void restart(uint32_t pid);
+
+		/**
+		* @brief Marks a process as ended, its slot is given back after the release delay
+		* @function end
+		* @param {uint32_t} pid - The pid of the process
+		* @param {uint64_t} now - The timestamp of the end
+		*/
+		void end(uint32_t pid, uint64_t now);
+
+		/**
+		* @brief Adds bytes to a counter of a process, taking a slot if it has none
+		* @function add
+		* @param {uint32_t} pid - The pid of the process
+		* @param {size_t} counter - The counter, 0 or 1
+		* @param {uint64_t} bytes - The bytes to add
+		* @returns {bool} true if the bytes were added, false if the pid is 0 or the table is full
+		*/
+		bool add(uint32_t pid, size_t counter, uint64_t bytes);
+
+		/**
+		* @brief Gives back the slots of the processes ended for longer than the release delay
+		* @function releaseEnded
+		* @param {uint64_t} now - The timestamp of the current event
+		*/
+		void releaseEnded(uint64_t now);
+
+		/**
+		* @brief Takes the bytes counted for a process since the previous call, from any thread
+		* @function take
+		* @param {uint32_t} pid - The pid of the process
+		* @param {uint64_t} first - A reference where the bytes of the counter 0 will be stored
+		* @param {uint64_t} second - A reference where the bytes of the counter 1 will be stored
+		* @returns {bool} true if the process has counters, false otherwise
+		*/
+		bool take(uint32_t pid, uint64_t& first, uint64_t& second);
+
+		/**
+		* @brief Gets the number of processes holding counters, ended ones included until they are released
+		* @function getTrackedProcesses
+		* @returns {size_t} the number of processes
+		*/
+		size_t getTrackedProcesses() const;
+
+	private:
+
+		/**
+		* @struct Release
+		* @brief An ended process waiting for its release, stale once its slot is restarted or ended again
+		*/
+		struct Release
+		{
+			size_t slot;
+			uint64_t endedAt;
+		};
+
+		/**
+		* @struct Slot
+		* @brief The counters of one process, a pid of 0 marks a free slot and RELEASED a slot given back
+		*/
+		struct Slot
+		{
+			std::atomic<uint32_t> pid{ 0 };
+			std::atomic<uint64_t> bytes[2] = { { 0 }, { 0 } };
+			uint64_t endedAt = 0;
+		};
+
+		/**
+		* @var {uint32_t} RELEASED
+		* @brief The pid of a slot given back by an ended process, the probes go on past it
+		*/
+		static constexpr uint32_t RELEASED = UINT32_MAX;
+
+		/**
+		* @brief Finds the slot of a process with linear probing
+		* @param {uint32_t} pid - The pid of the process
+		* @returns {Slot*} the slot, nullptr if not found
+		*/
+		Slot* find(uint32_t pid);
+
+		/**
+		* @brief Finds the slot of a process, giving it one if it has none
+		* @param {uint32_t} pid - The pid of the process
+		* @returns {Slot*} the slot, nullptr if the table is full
+		*/
+		Slot* claim(uint32_t pid);
+
+		/**
+		* @brief Gives a slot back, and frees it with the released ones before it when it ends no probe sequence
+		* @param {size_t} slot - The index of the slot, holding an ended process
+		*/
+		void release(size_t slot);
+
+		/**
+		* @brief Releases every process ended for longer than the delay by sweeping the table, then queues the
+		*        others again in the order they ended
+		* @param {uint64_t} now - The timestamp of the current event
+		*/
+		void sweep(uint64_t now);
+
+		/**
+		* @var {uint64_t} releaseDelay
+		* @brief The time the counters of an ended process are kept
+		*/
+		uint64_t releaseDelay;
+
+		/**
+		* @var {std::unique_ptr<Slot[]>} slots
+		* @brief The slots, CAPACITY of them
+		*/
+		std::unique_ptr<Slot[]> slots;
+
+		/**
+		* @var {std::unique_ptr<Release[]>} releases
+		* @brief The ring of the ended processes, CAPACITY of them, only used by the event thread
+		*/
+		std::unique_ptr<Release[]> releases;
+
+		/**
+		* @var {size_t} releaseHead
+		* @brief The position of the oldest end in the ring
+		*/
+		size_t releaseHead = 0;
+
+		/**
+		* @var {size_t} releaseCount
+		* @brief The number of ends in the ring
+		*/
+		size_t releaseCount = 0;
+
+		/**
+		* @var {bool} releasesLost
+		* @brief true when an end did not fit in the ring, the next release sweeps the table
+		*/
+		bool releasesLost = false;
+
+		/**
+		* @var {std::atomic<size_t>} trackedProcesses
+		* @brief The number of slots holding a process
+		*/
+		std::atomic<size_t> trackedProcesses{ 0 };
+
+		/**
+		* @var {size_t} usedSlots
+		* @brief The number of slots holding a process or released, only used by the event thread
+		*/
+		size_t usedSlots = 0;
+
+		/**
+		* @var {uint64_t} nextRelease
+		* @brief The time the next ended process is due to be released, UINT64_MAX if none is waiting
+		*/
+		uint64_t nextRelease = UINT64_MAX;
+};
@@ -0,0 +1,141 @@
+/**
+ * @file PowerHistory.cpp
+ * @brief Definition of the power history of the monitored applications.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "PowerHistory.h"
+
+#include <algorithm>
+
+PowerHistory::PowerHistory(size_t slotCount, size_t retention) : retention(std::max<size_t>(retention, 1)), slots(new std::atomic<Slot*>[slotCount]), slotCount(slotCount)
+{
+	for (size_t i = 0; i < slotCount; i++)
+	{
+		slots[i].store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+PowerHistory::~PowerHistory()
+{
+	for (size_t i = 0; i < slotCount; i++)
+	{
+		delete slots[i].load(std::memory_order_relaxed);
+	}
+}
+
+size_t PowerHistory::getRetention() const
+{
+	return retention;
+}
+
+void PowerHistory::append(AppId id, ComponentType component, const Sample& sample)
+{
+	if (id.slot >= slotCount)
+	{
+		return;
+	}
+
+	// The rings of a slot are allocated once and kept for the next applications using it, with one
+	// spare entry for the frame being written so that a reader always has the whole retention
+	Slot* slot = slots[id.slot].load(std::memory_order_relaxed);
+	if (slot == nullptr)
+	{
+		slot = new Slot();
+		for (Ring& ring : slot->rings)
+		{
+			ring.samples.reset(new Sample[retention + 1]);
+		}
+		slots[id.slot].store(slot, std::memory_order_release);
+	}
+
+	// A reader seeing the new generation sees the emptied rings, one still on the old generation
+	// finds the slot unclaimed when it checks its copy
+	if (slot->generation.load(std::memory_order_relaxed) != id.generation)
+	{
+		slot->generation.store(UNCLAIMED, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		for (Ring& ring : slot->rings)
+		{
+			ring.head.store(0, std::memory_order_relaxed);
+		}
+		slot->generation.store(id.generation, std::memory_order_release);
+	}
+
+	Ring& ring = slot->rings[static_cast<size_t>(component)];
+	uint64_t head = ring.head.load(std::memory_order_relaxed);
+	ring.samples[head % (retention + 1)] = sample;
+	ring.head.store(head + 1, std::memory_order_release);
+}
+
+void PowerHistory::latest(AppId id, ComponentType component, size_t count, std::vector<Sample>& samples) const
+{
+	collect(id, component, count, Clock::time_point::min(), Clock::time_point::max(), samples);
+}
+
+void PowerHistory::query(AppId id, ComponentType component, Clock::time_point from, Clock::time_point to, std::vector<Sample>& samples) const
+{
+	collect(id, component, retention, from, to, samples);
+}
+
+void PowerHistory::collect(AppId id, ComponentType component, size_t count, Clock::time_point from, Clock::time_point to, std::vector<Sample>& samples) const
+{
+	samples.clear();
+	if (id.slot >= slotCount)
+	{
+		return;
+	}
+
+	const Slot* slot = slots[id.slot].load(std::memory_order_acquire);
+	if (slot == nullptr)
+	{
+		return;
+	}
+
+	uint32_t generation = slot->generation.load(std::memory_order_acquire);
+	if (generation != id.generation)
+	{
+		return;
+	}
+
+	// Walk back from the newest frame, the frames are appended in time order
+	const Ring& ring = slot->rings[static_cast<size_t>(component)];
+	uint64_t head = ring.head.load(std::memory_order_acquire);
+	uint64_t first = head > retention ? head - retention : 0;
+	uint64_t oldest = head;
+	for (uint64_t index = head; index > first && samples.size() < count; index--)
+	{
+		const Sample& sample = ring.samples[(index - 1) % (retention + 1)];
+		if (sample.timestamp > to)
+		{
+			continue;
+		}
+
+		if (sample.timestamp < from)
+		{
+			break;
+		}
+
+		samples.push_back(sample);
+		oldest = index - 1;
+	}
+
+	// The spare entry may have been written over the oldest frames copied, and a new generation means
+	// the whole copy is from another application
+	std::atomic_thread_fence(std::memory_order_acquire);
+	uint64_t headAfter = ring.head.load(std::memory_order_relaxed);
+	if (slot->generation.load(std::memory_order_relaxed) != generation)
+	{
+		samples.clear();
+		return;
+	}
+
+	uint64_t firstValid = headAfter > retention ? headAfter - retention : 0;
+	if (oldest < firstValid)
+	{
+		samples.resize(samples.size() - std::min<size_t>(samples.size(), firstValid - oldest));
+	}
+
+	std::reverse(samples.begin(), samples.end());
+}
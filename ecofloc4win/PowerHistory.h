@@ -0,0 +1,152 @@
+/**
+ * @file PowerHistory.h
+ * @brief Implementation of the power history of the monitored applications.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "AppSlots.h"
+#include "ComponentType.h"
+
+/**
+ * @class PowerHistory
+ * @brief Keeps the last output frames of every application on every component in fixed ring buffers.
+ *
+ * Each application slot gets one ring per component the first time it is appended to, the rings are
+ * reused when the slot goes to another application and are never reallocated. Only the clock thread
+ * appends. The readers copy what they need and check afterwards that the clock thread did not
+ * overwrite it meanwhile, they never block it.
+ */
+class PowerHistory
+{
+	public:
+
+		using Clock = std::chrono::system_clock;
+
+		/**
+		* @struct Sample
+		* @brief What an application used on a component during one output frame
+		*/
+		struct Sample
+		{
+			Clock::time_point timestamp;
+			double watts;
+			double joules;
+		};
+
+		/**
+		* @brief Builds the history
+		*
+		* @param {size_t} slotCount - The number of application slots, every slot index is below it
+		* @param {size_t} retention - The number of frames kept for each application and component
+		*/
+		PowerHistory(size_t slotCount, size_t retention);
+
+		~PowerHistory();
+
+		PowerHistory(const PowerHistory&) = delete;
+		PowerHistory& operator=(const PowerHistory&) = delete;
+
+		/**
+		* @brief Gets the number of frames kept for each application and component
+		* @function getRetention
+		* @returns {size_t} the number of frames
+		*/
+		size_t getRetention() const;
+
+		/**
+		* @brief Appends a frame to the ring of an application, the oldest frame is dropped once it is full
+		* @function append
+		* @param {AppId} id - The application, its ring starts empty if its slot was used before
+		* @param {ComponentType} component - The component
+		* @param {Sample} sample - The frame, newer than the previous one
+		*/
+		void append(AppId id, ComponentType component, const Sample& sample);
+
+		/**
+		* @brief Gets the last frames of an application
+		* @function latest
+		* @param {AppId} id - The application
+		* @param {ComponentType} component - The component
+		* @param {size_t} count - The maximum number of frames
+		* @param {std::vector<Sample>} samples - A reference where the frames are stored from the oldest, reused by the caller
+		*/
+		void latest(AppId id, ComponentType component, size_t count, std::vector<Sample>& samples) const;
+
+		/**
+		* @brief Gets the frames of an application ending between two times
+		* @function query
+		* @param {AppId} id - The application
+		* @param {ComponentType} component - The component
+		* @param {Clock::time_point} from - The earliest end of a frame
+		* @param {Clock::time_point} to - The latest end of a frame
+		* @param {std::vector<Sample>} samples - A reference where the frames are stored from the oldest, reused by the caller
+		*/
+		void query(AppId id, ComponentType component, Clock::time_point from, Clock::time_point to, std::vector<Sample>& samples) const;
+
+	private:
+
+		/**
+		* @struct Ring
+		* @brief The frames of one component, the counter on its own cache line so the rings do not share any
+		*/
+		struct alignas(64) Ring
+		{
+			std::atomic<uint64_t> head{ 0 };
+			std::unique_ptr<Sample[]> samples;
+		};
+
+		/**
+		* @struct Slot
+		* @brief The rings of the application using a slot
+		*/
+		struct Slot
+		{
+			std::atomic<uint32_t> generation{ UNCLAIMED };
+			Ring rings[COMPONENT_COUNT];
+		};
+
+		/**
+		* @var {uint32_t} UNCLAIMED
+		* @brief The generation of a slot being given to another application
+		*/
+		static constexpr uint32_t UNCLAIMED = UINT32_MAX;
+
+		/**
+		* @brief Copies the newest frames of a ring ending between two times
+		* @param {AppId} id - The application
+		* @param {ComponentType} component - The component
+		* @param {size_t} count - The maximum number of frames
+		* @param {Clock::time_point} from - The earliest end of a frame
+		* @param {Clock::time_point} to - The latest end of a frame
+		* @param {std::vector<Sample>} samples - A reference where the frames are stored from the oldest
+		*/
+		void collect(AppId id, ComponentType component, size_t count, Clock::time_point from, Clock::time_point to, std::vector<Sample>& samples) const;
+
+		/**
+		* @var {size_t} retention
+		* @brief The number of frames of each ring
+		*/
+		size_t retention;
+
+		/**
+		* @var {std::unique_ptr<std::atomic<Slot*>[]>} slots
+		* @brief The rings of each slot, allocated by the clock thread on the first append
+		*/
+		std::unique_ptr<std::atomic<Slot*>[]> slots;
+
+		/**
+		* @var {size_t} slotCount
+		* @brief The number of slots
+		*/
+		size_t slotCount;
+};
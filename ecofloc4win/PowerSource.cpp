@@ -0,0 +1,186 @@
+/**
+ * @file PowerSource.cpp
+ * @brief Definition of the CPU power sources.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "PowerSource.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#include "CPU.h"
+#else
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+std::unique_ptr<PowerSource> PowerSource::create()
+{
+	if (!CPU::SensorBackend::getInstance().isAvailable())
+	{
+		return nullptr;
+	}
+
+	return std::make_unique<SensorPowerSource>();
+}
+
+std::string SensorPowerSource::getName() const
+{
+	return "Wrapper.dll sensors";
+}
+
+bool SensorPowerSource::readEnergy(double& joules)
+{
+	double power = 0.0;
+	if (!CPU::getCurrentPower(power))
+	{
+		return false;
+	}
+
+	auto now = std::chrono::steady_clock::now();
+	if (started)
+	{
+		double elapsed = std::chrono::duration<double>(now - lastTime).count();
+		energy += (lastPower + power) / 2 * elapsed;
+	}
+
+	started = true;
+	lastPower = power;
+	lastTime = now;
+
+	joules = energy;
+	return true;
+}
+
+std::chrono::milliseconds SensorPowerSource::getCadence() const
+{
+	// Wrapper.dll only refreshes its sensors every 2 seconds
+	return std::chrono::milliseconds(2000);
+}
+
+#else
+
+std::unique_ptr<PowerSource> PowerSource::create()
+{
+	auto source = std::make_unique<RaplPowerSource>();
+	if (!source->isOpen())
+	{
+		return nullptr;
+	}
+
+	return source;
+}
+
+RaplPowerSource::RaplPowerSource(const std::string& root)
+{
+	// Only the package zones (intel-rapl:N) are read, their subzones are already included in them
+	for (int package = 0; ; package++)
+	{
+		std::string zone = root + "/intel-rapl:" + std::to_string(package);
+
+		Domain domain;
+		domain.fd = open((zone + "/energy_uj").c_str(), O_RDONLY);
+		if (domain.fd < 0)
+		{
+			break;
+		}
+
+		int rangeFd = open((zone + "/max_energy_range_uj").c_str(), O_RDONLY);
+		if (rangeFd >= 0)
+		{
+			readCounter(rangeFd, domain.maxRange);
+			close(rangeFd);
+		}
+
+		if (!readCounter(domain.fd, domain.last))
+		{
+			std::cerr << "Failed to read " << zone << "/energy_uj" << std::endl;
+			close(domain.fd);
+			continue;
+		}
+
+		domains.push_back(domain);
+	}
+
+	if (domains.empty())
+	{
+		std::cerr << "No RAPL package found under " << root << std::endl;
+	}
+}
+
+RaplPowerSource::~RaplPowerSource()
+{
+	for (const auto& domain : domains)
+	{
+		close(domain.fd);
+	}
+}
+
+bool RaplPowerSource::readCounter(int fd, uint64_t& value)
+{
+	char buffer[32];
+	ssize_t size = pread(fd, buffer, sizeof(buffer) - 1, 0);
+	if (size <= 0)
+	{
+		return false;
+	}
+
+	buffer[size] = '\0';
+	value = std::strtoull(buffer, nullptr, 10);
+	return true;
+}
+
+bool RaplPowerSource::isOpen() const
+{
+	return !domains.empty();
+}
+
+std::string RaplPowerSource::getName() const
+{
+	return "RAPL powercap";
+}
+
+bool RaplPowerSource::readEnergy(double& joules)
+{
+	if (domains.empty())
+	{
+		return false;
+	}
+
+	for (auto& domain : domains)
+	{
+		uint64_t value = 0;
+		if (!readCounter(domain.fd, value))
+		{
+			return false;
+		}
+
+		// The counter wraps around once it reaches max_energy_range_uj, without a readable range the
+		// wrapped sample is skipped and the counter starts again from its new value
+		if (value >= domain.last)
+		{
+			accumulated += value - domain.last;
+		}
+		else if (domain.maxRange > domain.last)
+		{
+			accumulated += domain.maxRange - domain.last + value;
+		}
+		domain.last = value;
+	}
+
+	joules = accumulated / 1e6;
+	return true;
+}
+
+std::chrono::milliseconds RaplPowerSource::getCadence() const
+{
+	// The counters are updated about every millisecond
+	return std::chrono::milliseconds(0);
+}
+
+#endif
@@ -0,0 +1,170 @@
+/**
+ * @file PowerSource.h
+ * @brief Implementation of the CPU power sources.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @class PowerSource
+ * @brief Interface of every source able to tell how much energy the CPU used.
+ *
+ * A source exposes a cumulative energy counter: the samplers read it at the start and at the end
+ * of an interval and use the difference, whatever the source measures internally.
+ */
+class PowerSource
+{
+	public:
+		virtual ~PowerSource() = default;
+
+		/**
+		* @brief Gets the name of the source, used in error messages
+		* @function getName
+		* @returns {std::string} the name of the source
+		*/
+		virtual std::string getName() const = 0;
+
+		/**
+		* @brief Reads the energy used by the CPU since the source was created
+		* @function readEnergy
+		* @param {double} joules - A reference to a double where the cumulative energy in Joules will be stored
+		* @returns {bool} true if the energy was successfully retrieved, false otherwise
+		*/
+		virtual bool readEnergy(double& joules) = 0;
+
+		/**
+		* @brief Gets how often the source refreshes its measure, reading it faster gives nothing new
+		* @function getCadence
+		* @returns {std::chrono::milliseconds} the refresh period, 0 if the source can follow any period
+		*/
+		virtual std::chrono::milliseconds getCadence() const = 0;
+
+		/**
+		* @brief Creates the best power source available on this machine
+		* @function create
+		* @returns {std::unique_ptr<PowerSource>} the source, nullptr if none is available
+		*/
+		static std::unique_ptr<PowerSource> create();
+};
+
+#ifdef _WIN32
+
+/**
+ * @class SensorPowerSource
+ * @brief Power source based on the hardware sensors of Wrapper.dll.
+ *
+ * The sensors only give an instantaneous power, the energy counter is built by integrating
+ * the power between two readings with the trapezoidal rule.
+ */
+class SensorPowerSource : public PowerSource
+{
+	private:
+
+		/**
+		* @var {bool} started
+		* @brief true once a first power has been read
+		*/
+		bool started = false;
+
+		/**
+		* @var {double} lastPower
+		* @brief the power in Watt of the last reading
+		*/
+		double lastPower = 0.0;
+
+		/**
+		* @var {std::chrono::steady_clock::time_point} lastTime
+		* @brief the time of the last reading
+		*/
+		std::chrono::steady_clock::time_point lastTime;
+
+		/**
+		* @var {double} energy
+		* @brief the energy in Joules integrated since the first reading
+		*/
+		double energy = 0.0;
+
+	public:
+		std::string getName() const override;
+		bool readEnergy(double& joules) override;
+		std::chrono::milliseconds getCadence() const override;
+};
+
+#else
+
+/**
+ * @class RaplPowerSource
+ * @brief Power source reading the RAPL energy counters of the powercap interface.
+ *
+ * Each package exposes a cumulative energy_uj counter, reading it costs one pread per package.
+ */
+class RaplPowerSource : public PowerSource
+{
+	private:
+
+		/**
+		* @struct Domain
+		* @brief An opened package counter
+		*/
+		struct Domain
+		{
+			int fd = -1;
+			uint64_t maxRange = 0;
+			uint64_t last = 0;
+		};
+
+		/**
+		* @var {std::vector<Domain>} domains
+		* @brief the opened package counters
+		*/
+		std::vector<Domain> domains;
+
+		/**
+		* @var {uint64_t} accumulated
+		* @brief the energy in microjoules counted since the source was opened
+		*/
+		uint64_t accumulated = 0;
+
+		/**
+		* @brief Reads the raw value of a counter
+		* @param {int} fd - the file descriptor of the counter
+		* @param {uint64_t} value - A reference where the value will be stored
+		* @returns {bool} true if the value was read, false otherwise
+		*/
+		static bool readCounter(int fd, uint64_t& value);
+
+	public:
+
+		/**
+		* @brief Opens every package counter found under root
+		*
+		* @param {std::string} root - the powercap directory
+		*/
+		explicit RaplPowerSource(const std::string& root = "/sys/class/powercap");
+
+		~RaplPowerSource() override;
+
+		RaplPowerSource(const RaplPowerSource&) = delete;
+		RaplPowerSource& operator=(const RaplPowerSource&) = delete;
+
+		/**
+		* @brief Returns if at least one package counter could be opened
+		* @function isOpen
+		* @returns {bool} true if the source can be read, false otherwise
+		*/
+		bool isOpen() const;
+
+		std::string getName() const override;
+		bool readEnergy(double& joules) override;
+		std::chrono::milliseconds getCadence() const override;
+};
+
+#endif
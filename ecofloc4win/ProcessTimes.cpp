@@ -0,0 +1,237 @@
+/**
+ * @file ProcessTimes.cpp
+ * @brief Definition of the system-wide process times snapshot.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "ProcessTimes.h"
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+/**
+ * @brief Defines the parts of the native process information used here
+ * @{
+ */
+#define SYSTEM_PROCESS_INFORMATION_CLASS 5
+#define STATUS_SUCCESS_CODE ((NTSTATUS)0x00000000L)
+#define STATUS_INFO_LENGTH_MISMATCH_CODE ((NTSTATUS)0xC0000004L)
+
+typedef struct NativeUnicodeString_st
+{
+	USHORT Length;
+	USHORT MaximumLength;
+	PWSTR Buffer;
+} NativeUnicodeString_t;
+
+typedef struct SystemProcessInformation_st
+{
+	ULONG NextEntryOffset;
+	ULONG NumberOfThreads;
+	LARGE_INTEGER WorkingSetPrivateSize;
+	ULONG HardFaultCount;
+	ULONG NumberOfThreadsHighWatermark;
+	ULONGLONG CycleTime;
+	LARGE_INTEGER CreateTime;
+	LARGE_INTEGER UserTime;
+	LARGE_INTEGER KernelTime;
+	NativeUnicodeString_t ImageName;
+	LONG BasePriority;
+	HANDLE UniqueProcessId;
+} SystemProcessInformation_t;
+
+typedef NTSTATUS(NTAPI* NtQuerySystemInformation_t)(ULONG, void*, ULONG, ULONG*);
+/**
+ * @}
+ */
+
+/**
+ * @brief Converts a FILETIME structure to a uint64_t.
+ *
+ * @param ft The FILETIME structure to convert.
+ * @return uint64_t The converted value.
+ */
+static uint64_t fromFileTime(const FILETIME& ft)
+{
+	ULARGE_INTEGER uli = { 0 };
+	uli.LowPart = ft.dwLowDateTime;
+	uli.HighPart = ft.dwHighDateTime;
+	return uli.QuadPart;
+}
+
+bool ProcessTimes::capture(const std::vector<int>& pids)
+{
+	static const NtQuerySystemInformation_t ntQuerySystemInformation = reinterpret_cast<NtQuerySystemInformation_t>(
+		GetProcAddress(GetModuleHandle(L"ntdll.dll"), "NtQuerySystemInformation"));
+
+	if (!ntQuerySystemInformation)
+	{
+		std::cerr << "Failed to locate NtQuerySystemInformation in ntdll.dll." << std::endl;
+		return false;
+	}
+
+	wanted.assign(pids.begin(), pids.end());
+	std::sort(wanted.begin(), wanted.end());
+	entries.clear();
+
+	FILETIME idle_time, kernel_time, user_time;
+	if (!GetSystemTimes(&idle_time, &kernel_time, &user_time))
+	{
+		std::cerr << "Failed to get CPU Time: Error " << GetLastError() << std::endl;
+		return false;
+	}
+
+	// The kernel time already includes the idle time
+	systemTime = fromFileTime(kernel_time) + fromFileTime(user_time);
+
+	if (buffer.empty())
+	{
+		buffer.resize(256 * 1024);
+	}
+
+	NTSTATUS status;
+	ULONG needed = 0;
+	while ((status = ntQuerySystemInformation(SYSTEM_PROCESS_INFORMATION_CLASS, buffer.data(), static_cast<ULONG>(buffer.size()), &needed)) == STATUS_INFO_LENGTH_MISMATCH_CODE)
+	{
+		// Leave room for the processes started between the two calls
+		buffer.resize(std::max<size_t>(needed, buffer.size()) + 64 * 1024);
+	}
+
+	if (status != STATUS_SUCCESS_CODE)
+	{
+		std::cerr << "Failed to query the process list. Status: " << status << std::endl;
+		return false;
+	}
+
+	size_t offset = 0;
+	while (true)
+	{
+		const SystemProcessInformation_t* info = reinterpret_cast<const SystemProcessInformation_t*>(buffer.data() + offset);
+		int pid = static_cast<int>(reinterpret_cast<ULONG_PTR>(info->UniqueProcessId));
+
+		if (std::binary_search(wanted.begin(), wanted.end(), pid))
+		{
+			entries.push_back({ pid, static_cast<uint64_t>(info->KernelTime.QuadPart + info->UserTime.QuadPart) });
+		}
+
+		if (info->NextEntryOffset == 0)
+		{
+			break;
+		}
+		offset += info->NextEntryOffset;
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+	{
+		return a.pid < b.pid;
+	});
+
+	return true;
+}
+
+#else
+
+bool ProcessTimes::capture(const std::vector<int>& pids)
+{
+	static const uint64_t ticksPerSecond = static_cast<uint64_t>(sysconf(_SC_CLK_TCK));
+	const uint64_t toFileTimeUnits = 10000000 / ticksPerSecond;
+
+	wanted.assign(pids.begin(), pids.end());
+	std::sort(wanted.begin(), wanted.end());
+	wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+	entries.clear();
+
+	std::ifstream stat("/proc/stat");
+	std::string cpu;
+	uint64_t value = 0;
+	systemTime = 0;
+	if (!(stat >> cpu) || cpu != "cpu")
+	{
+		std::cerr << "Failed to read /proc/stat" << std::endl;
+		return false;
+	}
+
+	// user nice system idle iowait irq softirq steal, guest times are already counted in user
+	for (int field = 0; field < 8 && stat >> value; field++)
+	{
+		systemTime += value;
+	}
+	systemTime *= toFileTimeUnits;
+
+	if (buffer.size() < 1024)
+	{
+		buffer.resize(1024);
+	}
+
+	for (int pid : wanted)
+	{
+		char path[64];
+		std::snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+
+		FILE* file = std::fopen(path, "r");
+		if (!file)
+		{
+			continue;
+		}
+
+		size_t size = std::fread(buffer.data(), 1, buffer.size() - 1, file);
+		std::fclose(file);
+		buffer[size] = '\0';
+
+		// The command name may contain spaces, the fields start after its closing parenthesis
+		const char* fields = std::strrchr(reinterpret_cast<const char*>(buffer.data()), ')');
+		if (!fields)
+		{
+			continue;
+		}
+
+		unsigned long long utime = 0, stime = 0;
+		if (std::sscanf(fields + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu", &utime, &stime) == 2)
+		{
+			entries.push_back({ pid, (utime + stime) * toFileTimeUnits });
+		}
+	}
+
+	return true;
+}
+
+#endif
+
+bool ProcessTimes::getTime(int pid, uint64_t& time) const
+{
+	auto it = std::lower_bound(entries.begin(), entries.end(), pid, [](const Entry& entry, int value)
+	{
+		return entry.pid < value;
+	});
+
+	if (it == entries.end() || it->pid != pid)
+	{
+		return false;
+	}
+
+	time = it->time;
+	return true;
+}
+
+uint64_t ProcessTimes::getSystemTime() const
+{
+	return systemTime;
+}
+
+const std::vector<ProcessTimes::Entry>& ProcessTimes::getEntries() const
+{
+	return entries;
+}
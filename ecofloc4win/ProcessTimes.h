@@ -0,0 +1,91 @@
+/**
+ * @file ProcessTimes.h
+ * @brief Implementation of the system-wide process times snapshot.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class ProcessTimes
+ * @brief Snapshot of the CPU time used by a set of processes and by the whole system.
+ *
+ * One capture costs a single system query on Windows (a /proc sweep on Linux) whatever the
+ * number of processes, and fills a flat table sorted by pid that every sampler can read.
+ * All the times are expressed in 100-nanosecond intervals.
+ */
+class ProcessTimes
+{
+	public:
+
+		/**
+		* @struct Entry
+		* @brief The CPU time (kernel + user) used by one process
+		*/
+		struct Entry
+		{
+			int pid;
+			uint64_t time;
+		};
+
+		/**
+		* @brief Captures the times of the given processes and of the whole system
+		* @function capture
+		* @param {std::vector<int>} pids - the pids to capture, the order does not matter
+		* @returns {bool} true if the snapshot was taken, false otherwise
+		*/
+		bool capture(const std::vector<int>& pids);
+
+		/**
+		* @brief Gets the time used by a process of the snapshot
+		* @function getTime
+		* @param {int} pid - the pid of the process
+		* @param {uint64_t} time - A reference where the time will be stored
+		* @returns {bool} true if the process was found in the snapshot, false otherwise
+		*/
+		bool getTime(int pid, uint64_t& time) const;
+
+		/**
+		* @brief Gets the total CPU time of the system at the moment of the snapshot
+		* @function getSystemTime
+		* @returns {uint64_t} the total CPU time (idle included) of all the cores
+		*/
+		uint64_t getSystemTime() const;
+
+		/**
+		* @brief Gets the table of the captured processes
+		* @function getEntries
+		* @returns {std::vector<Entry>} the captured processes sorted by pid
+		*/
+		const std::vector<Entry>& getEntries() const;
+
+	private:
+
+		/**
+		* @var {std::vector<Entry>} entries
+		* @brief the captured processes sorted by pid
+		*/
+		std::vector<Entry> entries;
+
+		/**
+		* @var {uint64_t} systemTime
+		* @brief the total CPU time of the system
+		*/
+		uint64_t systemTime = 0;
+
+		/**
+		* @var {std::vector<int>} wanted
+		* @brief the sorted pids requested by the last capture
+		*/
+		std::vector<int> wanted;
+
+		/**
+		* @var {std::vector<unsigned char>} buffer
+		* @brief the system query buffer, kept between captures
+		*/
+		std::vector<unsigned char> buffer;
+};
@@ -0,0 +1,57 @@
+/**
+ * @file Resampler.cpp
+ * @brief Definition of the resampling of the component energies onto the output timeline.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "Resampler.h"
+
+void Resampler::add(AppId app, ComponentType component, Clock::time_point start, Clock::time_point end, double joules)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	segments.push_back({ app, component, start, end, joules });
+}
+
+void Resampler::resample(Clock::time_point end, std::vector<Output>& outputs)
+{
+	outputs.clear();
+	positions.clear();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	size_t kept = 0;
+	for (size_t i = 0; i < segments.size(); i++)
+	{
+		Segment& segment = segments[i];
+		if (segment.start >= end)
+		{
+			segments[kept++] = segment;
+			continue;
+		}
+
+		// Constant power over the window: take the share before the end of the frame, what is before
+		// the start of the frame was reported late and is taken as well
+		double taken = segment.joules;
+		if (segment.end > end)
+		{
+			double share = std::chrono::duration<double>(end - segment.start).count()
+				/ std::chrono::duration<double>(segment.end - segment.start).count();
+			taken = segment.joules * share;
+
+			segment.joules -= taken;
+			segment.start = end;
+			segments[kept++] = segment;
+		}
+
+		uint64_t key = (static_cast<uint64_t>(segment.app.generation) << 32) | segment.app.slot;
+		auto inserted = positions.emplace(key, outputs.size());
+		if (inserted.second)
+		{
+			outputs.push_back({ segment.app, {} });
+		}
+
+		outputs[inserted.first->second].joules[static_cast<size_t>(segment.component)] += taken;
+	}
+
+	segments.resize(kept);
+}
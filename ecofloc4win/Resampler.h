@@ -0,0 +1,93 @@
+/**
+ * @file Resampler.h
+ * @brief Implementation of the resampling of the component energies onto the output timeline.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "AppSlots.h"
+#include "ComponentType.h"
+
+/**
+ * @class Resampler
+ * @brief Spreads the energies measured on the windows of each sampler over the windows of the output.
+ *
+ * Every sampler runs at its own cadence, so its windows do not match the output frames. The energy of
+ * a sampled window is assumed to be used at a constant power and is split between the output frames it
+ * overlaps. Energy reported after its frame was resampled goes to the next frame instead of being lost.
+ */
+class Resampler
+{
+	public:
+
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		* @struct Output
+		* @brief The energy of one application on each component during an output frame
+		*/
+		struct Output
+		{
+			AppId app;
+			double joules[COMPONENT_COUNT];
+		};
+
+		/**
+		* @brief Adds the energy an application used on a component during a sampled window, thread safe
+		* @function add
+		* @param {AppId} app - The application
+		* @param {ComponentType} component - The component
+		* @param {Clock::time_point} start - The start of the window
+		* @param {Clock::time_point} end - The end of the window
+		* @param {double} joules - The energy used during the window
+		*/
+		void add(AppId app, ComponentType component, Clock::time_point start, Clock::time_point end, double joules);
+
+		/**
+		* @brief Takes the energy falling before the end of an output frame
+		* @function resample
+		* @param {Clock::time_point} end - The end of the output frame
+		* @param {std::vector<Output>} outputs - A reference where the energy of each application is stored
+		*/
+		void resample(Clock::time_point end, std::vector<Output>& outputs);
+
+	private:
+
+		/**
+		* @struct Segment
+		* @brief The part of a sampled window not resampled yet
+		*/
+		struct Segment
+		{
+			AppId app;
+			ComponentType component;
+			Clock::time_point start;
+			Clock::time_point end;
+			double joules;
+		};
+
+		/**
+		* @var {std::mutex} mutex
+		* @brief Protects segments, the samplers add to it concurrently
+		*/
+		std::mutex mutex;
+
+		/**
+		* @var {std::vector<Segment>} segments
+		* @brief The windows whose energy is not fully resampled
+		*/
+		std::vector<Segment> segments;
+
+		/**
+		* @var {std::unordered_map<uint64_t, size_t>} positions
+		* @brief The position of each application in the outputs being built, kept to reuse its buckets
+		*/
+		std::unordered_map<uint64_t, size_t> positions;
+};
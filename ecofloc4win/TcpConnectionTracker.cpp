@@ -0,0 +1,288 @@
+/**
+ * @file TcpConnectionTracker.cpp
+ * @brief Definition of the per-connection TCP traffic tracking.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "TcpConnectionTracker.h"
+
+#include <cstring>
+
+/**
+ * @brief Defines how many times a table is read again when it grew between the sizing and the read
+ */
+#define TABLE_READ_ATTEMPTS 3
+
+bool TcpConnectionTracker::Key::operator==(const Key& other) const
+{
+	return std::memcmp(this, &other, sizeof(Key)) == 0;
+}
+
+size_t TcpConnectionTracker::KeyHash::operator()(const Key& key) const
+{
+	static_assert(sizeof(Key) == 2 * 16 + 6 * sizeof(DWORD), "Key must not have padding");
+
+	const BYTE* bytes = reinterpret_cast<const BYTE*>(&key);
+	uint64_t hash = 1469598103934665603ULL;
+	for (size_t i = 0; i < sizeof(Key); i++)
+	{
+		hash = (hash ^ bytes[i]) * 1099511628211ULL;
+	}
+	return static_cast<size_t>(hash);
+}
+
+/**
+ * @brief Reads a TCP table into a buffer, growing it when the table does not fit
+ * @function readTable
+ * @param {ULONG} family - AF_INET or AF_INET6
+ * @param {std::vector<BYTE>} buffer - The buffer kept from one call to the next
+ * @returns {DWORD} the status of the last GetExtendedTcpTable call
+ */
+static DWORD readTable(ULONG family, std::vector<BYTE>& buffer)
+{
+	DWORD status = ERROR_INSUFFICIENT_BUFFER;
+	for (int attempt = 0; attempt < TABLE_READ_ATTEMPTS && status == ERROR_INSUFFICIENT_BUFFER; attempt++)
+	{
+		// A single call once the buffer is large enough, the grouping by pid makes the sorting useless
+		ULONG size = static_cast<ULONG>(buffer.size());
+		status = GetExtendedTcpTable(buffer.empty() ? nullptr : buffer.data(), &size, FALSE, family, TCP_TABLE_OWNER_PID_ALL, 0);
+
+		if (status == ERROR_INSUFFICIENT_BUFFER)
+		{
+			// Leave room for the connections opened before the next read
+			buffer.resize(size + size / 4);
+		}
+	}
+
+	return status;
+}
+
+/**
+ * @brief Tells if an IPv6 address is the loopback
+ * @function isLoopback
+ * @param {UCHAR[16]} addr - The address
+ * @returns {bool} true if the address is ::1, false otherwise
+ */
+static bool isLoopback(const UCHAR* addr)
+{
+	static const UCHAR loopback[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+	return std::memcmp(addr, loopback, sizeof(loopback)) == 0;
+}
+
+bool TcpConnectionTracker::readCounters(const Key& key, bool enable, uint64_t& bytesIn, uint64_t& bytesOut)
+{
+	TCP_ESTATS_DATA_RW_v0 rwData = { 0 };
+	rwData.EnableCollection = TRUE;
+	TCP_ESTATS_DATA_ROD_v0 dataRod = { 0 };
+	ULONG status;
+
+	if (key.family == AF_INET6)
+	{
+		MIB_TCP6ROW row = {};
+		row.State = MIB_TCP_STATE_ESTAB;
+		std::memcpy(&row.LocalAddr, key.localAddr, sizeof(key.localAddr));
+		std::memcpy(&row.RemoteAddr, key.remoteAddr, sizeof(key.remoteAddr));
+		row.dwLocalScopeId = key.localScopeId;
+		row.dwRemoteScopeId = key.remoteScopeId;
+		row.dwLocalPort = key.localPort;
+		row.dwRemotePort = key.remotePort;
+
+		if (enable && SetPerTcp6ConnectionEStats(&row, TcpConnectionEstatsData, reinterpret_cast<PUCHAR>(&rwData), 0, sizeof(rwData), 0) != NO_ERROR)
+		{
+			return false;
+		}
+
+		status = GetPerTcp6ConnectionEStats(&row, TcpConnectionEstatsData, nullptr, 0, 0, nullptr, 0, 0,
+			reinterpret_cast<PUCHAR>(&dataRod), 0, sizeof(dataRod));
+	}
+	else
+	{
+		MIB_TCPROW row = {};
+		row.dwState = MIB_TCP_STATE_ESTAB;
+		std::memcpy(&row.dwLocalAddr, key.localAddr, sizeof(DWORD));
+		std::memcpy(&row.dwRemoteAddr, key.remoteAddr, sizeof(DWORD));
+		row.dwLocalPort = key.localPort;
+		row.dwRemotePort = key.remotePort;
+
+		if (enable && SetPerTcpConnectionEStats(&row, TcpConnectionEstatsData, reinterpret_cast<PUCHAR>(&rwData), 0, sizeof(rwData), 0) != NO_ERROR)
+		{
+			return false;
+		}
+
+		status = GetPerTcpConnectionEStats(&row, TcpConnectionEstatsData, nullptr, 0, 0, nullptr, 0, 0,
+			reinterpret_cast<PUCHAR>(&dataRod), 0, sizeof(dataRod));
+	}
+
+	if (status != NO_ERROR)
+	{
+		return false;
+	}
+
+	bytesIn = dataRod.DataBytesIn;
+	bytesOut = dataRod.DataBytesOut;
+	return true;
+}
+
+bool TcpConnectionTracker::sample(const Key& key, uint64_t& bytesIn, uint64_t& bytesOut)
+{
+	bytesIn = 0;
+	bytesOut = 0;
+
+	auto it = connections.find(key);
+	if (it == connections.end())
+	{
+		// Enable ESTATS for this connection, the counters read right after are the baseline
+		Connection connection = { 0, 0, tick };
+		if (!readCounters(key, true, connection.bytesIn, connection.bytesOut))
+		{
+			return false;
+		}
+
+		connections.emplace(key, connection);
+		return true;
+	}
+
+	Connection& connection = it->second;
+	connection.lastTick = tick;
+
+	uint64_t currentIn = 0, currentOut = 0;
+	if (!readCounters(key, false, currentIn, currentOut))
+	{
+		return false;
+	}
+
+	// The counters only go back when the collection was restarted, take the new value as the baseline
+	bytesIn = currentIn >= connection.bytesIn ? currentIn - connection.bytesIn : 0;
+	bytesOut = currentOut >= connection.bytesOut ? currentOut - connection.bytesOut : 0;
+	connection.bytesIn = currentIn;
+	connection.bytesOut = currentOut;
+	return true;
+}
+
+bool TcpConnectionTracker::refresh()
+{
+	if (readTable(AF_INET, ipv4Table) != NO_ERROR)
+	{
+		return false;
+	}
+
+	collected.clear();
+
+	const MIB_TCPTABLE_OWNER_PID* ipv4 = reinterpret_cast<const MIB_TCPTABLE_OWNER_PID*>(ipv4Table.data());
+	for (DWORD i = 0; i < ipv4->dwNumEntries; i++)
+	{
+		const MIB_TCPROW_OWNER_PID& row = ipv4->table[i];
+		if (row.dwState != MIB_TCP_STATE_ESTAB || row.dwRemoteAddr == htonl(INADDR_LOOPBACK))
+		{
+			continue;
+		}
+
+		Key key = {};
+		std::memcpy(key.localAddr, &row.dwLocalAddr, sizeof(DWORD));
+		std::memcpy(key.remoteAddr, &row.dwRemoteAddr, sizeof(DWORD));
+		key.localPort = row.dwLocalPort;
+		key.remotePort = row.dwRemotePort;
+		key.pid = row.dwOwningPid;
+		key.family = AF_INET;
+		collected.push_back(key);
+	}
+
+	// IPv6 can be disabled, the IPv4 connections are still accounted then
+	if (readTable(AF_INET6, ipv6Table) == NO_ERROR)
+	{
+		const MIB_TCP6TABLE_OWNER_PID* ipv6 = reinterpret_cast<const MIB_TCP6TABLE_OWNER_PID*>(ipv6Table.data());
+		for (DWORD i = 0; i < ipv6->dwNumEntries; i++)
+		{
+			const MIB_TCP6ROW_OWNER_PID& row = ipv6->table[i];
+			if (row.dwState != MIB_TCP_STATE_ESTAB || isLoopback(row.ucRemoteAddr))
+			{
+				continue;
+			}
+
+			Key key = {};
+			std::memcpy(key.localAddr, row.ucLocalAddr, sizeof(key.localAddr));
+			std::memcpy(key.remoteAddr, row.ucRemoteAddr, sizeof(key.remoteAddr));
+			key.localScopeId = row.dwLocalScopeId;
+			key.remoteScopeId = row.dwRemoteScopeId;
+			key.localPort = row.dwLocalPort;
+			key.remotePort = row.dwRemotePort;
+			key.pid = row.dwOwningPid;
+			key.family = AF_INET6;
+			collected.push_back(key);
+		}
+	}
+
+	groupByPid();
+	return true;
+}
+
+void TcpConnectionTracker::groupByPid()
+{
+	buckets.clear();
+
+	// Count the connections of each process, then give each one a contiguous range of rows
+	for (const Key& key : collected)
+	{
+		buckets[key.pid].count++;
+	}
+
+	size_t offset = 0;
+	for (auto& [pid, bucket] : buckets)
+	{
+		bucket.begin = offset;
+		offset += bucket.count;
+		bucket.count = 0;
+	}
+
+	rows.resize(offset);
+	for (const Key& key : collected)
+	{
+		Bucket& bucket = buckets[key.pid];
+		rows[bucket.begin + bucket.count++] = key;
+	}
+}
+
+bool TcpConnectionTracker::takeBytes(int pid, uint64_t& sentBytes, uint64_t& receivedBytes)
+{
+	sentBytes = 0;
+	receivedBytes = 0;
+
+	auto it = buckets.find(static_cast<DWORD>(pid));
+	if (it == buckets.end())
+	{
+		return false;
+	}
+
+	for (size_t i = it->second.begin; i < it->second.begin + it->second.count; i++)
+	{
+		uint64_t bytesIn = 0, bytesOut = 0;
+		if (sample(rows[i], bytesIn, bytesOut))
+		{
+			sentBytes += bytesOut;
+			receivedBytes += bytesIn;
+		}
+	}
+
+	return true;
+}
+
+size_t TcpConnectionTracker::expire()
+{
+	size_t expired = 0;
+	for (auto it = connections.begin(); it != connections.end();)
+	{
+		if (it->second.lastTick != tick)
+		{
+			it = connections.erase(it);
+			expired++;
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	tick++;
+	return expired;
+}
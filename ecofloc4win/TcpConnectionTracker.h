@@ -0,0 +1,178 @@
+/**
+ * @file TcpConnectionTracker.h
+ * @brief Implementation of the per-connection TCP traffic tracking.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <winsock2.h>
+#include <windows.h>
+#include <iphlpapi.h>
+#include <tcpestats.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class TcpConnectionTracker
+ * @brief Turns the cumulative ESTATS counters of the TCP connections into per-tick byte deltas.
+ *
+ * A connection is identified by its 4-tuple and its owning pid. The extended statistics are enabled
+ * once, the first time the connection is seen, and its last counters are kept so that each sample
+ * gives the bytes transferred since the previous one. Connections that disappear from the table are
+ * expired.
+ *
+ * Each tick the IPv4 and IPv6 tables are read into buffers kept from one tick to the next and
+ * bucketed by owning pid once, so a process only visits its own connections.
+ */
+class TcpConnectionTracker
+{
+	public:
+
+		/**
+		* @brief Reads the IPv4 and IPv6 TCP tables and buckets their accounted connections by owning pid
+		* @function refresh
+		* @returns {bool} true if the IPv4 table could be read, false otherwise (the previous buckets are kept)
+		*/
+		bool refresh();
+
+		/**
+		* @brief Takes the bytes the connections of a process transferred since the previous tick
+		* @function takeBytes
+		* @param {int} pid - The pid of the process
+		* @param {uint64_t} sentBytes - A reference where the bytes sent will be stored
+		* @param {uint64_t} receivedBytes - A reference where the bytes received will be stored
+		* @returns {bool} true if the process owns connections in the collected tables, false otherwise
+		*/
+		bool takeBytes(int pid, uint64_t& sentBytes, uint64_t& receivedBytes);
+
+		/**
+		* @brief Forgets the connections that were not sampled since the previous call
+		* @function expire
+		* @returns {size_t} the number of expired connections
+		*/
+		size_t expire();
+
+	private:
+
+		/**
+		* @struct Key
+		* @brief The 4-tuple, the family and the owner of a connection, IPv4 addresses use the first 4 bytes
+		*
+		* The fields leave no padding so that a key can be compared and hashed as raw bytes.
+		*/
+		struct Key
+		{
+			BYTE localAddr[16];
+			BYTE remoteAddr[16];
+			DWORD localScopeId;
+			DWORD remoteScopeId;
+			DWORD localPort;
+			DWORD remotePort;
+			DWORD pid;
+			DWORD family;
+
+			bool operator==(const Key& other) const;
+		};
+
+		/**
+		* @struct KeyHash
+		* @brief Hashes the bytes of a Key
+		*/
+		struct KeyHash
+		{
+			size_t operator()(const Key& key) const;
+		};
+
+		/**
+		* @struct Connection
+		* @brief The last counters of a connection and the tick it was last sampled at
+		*/
+		struct Connection
+		{
+			uint64_t bytesIn;
+			uint64_t bytesOut;
+			uint32_t lastTick;
+		};
+
+		/**
+		* @struct Bucket
+		* @brief The range of the connections of one process in rows
+		*/
+		struct Bucket
+		{
+			size_t begin;
+			size_t count;
+		};
+
+		/**
+		* @brief Reads the cumulative data counters of a connection
+		* @function readCounters
+		* @param {Key} key - The connection
+		* @param {bool} enable - true to enable the collection before reading
+		* @param {uint64_t} bytesIn - A reference where the bytes received will be stored
+		* @param {uint64_t} bytesOut - A reference where the bytes sent will be stored
+		* @returns {bool} true if the counters could be read, false otherwise
+		*/
+		static bool readCounters(const Key& key, bool enable, uint64_t& bytesIn, uint64_t& bytesOut);
+
+		/**
+		* @brief Gets the bytes a connection transferred since its previous sample
+		* @function sample
+		* @param {Key} key - The connection
+		* @param {uint64_t} bytesIn - A reference where the bytes received will be stored
+		* @param {uint64_t} bytesOut - A reference where the bytes sent will be stored
+		* @returns {bool} true if the counters could be read, false otherwise (0 bytes the first time)
+		*/
+		bool sample(const Key& key, uint64_t& bytesIn, uint64_t& bytesOut);
+
+		/**
+		* @brief Groups the collected connections by owning pid into rows
+		* @function groupByPid
+		*/
+		void groupByPid();
+
+		/**
+		* @var {std::unordered_map<Key, Connection, KeyHash>} connections
+		* @brief The connections seen so far
+		*/
+		std::unordered_map<Key, Connection, KeyHash> connections;
+
+		/**
+		* @var {std::vector<BYTE>} ipv4Table
+		* @brief The buffer of the IPv4 TCP table, only grows
+		*/
+		std::vector<BYTE> ipv4Table;
+
+		/**
+		* @var {std::vector<BYTE>} ipv6Table
+		* @brief The buffer of the IPv6 TCP table, only grows
+		*/
+		std::vector<BYTE> ipv6Table;
+
+		/**
+		* @var {std::vector<Key>} collected
+		* @brief The accounted connections of both tables in table order
+		*/
+		std::vector<Key> collected;
+
+		/**
+		* @var {std::unordered_map<DWORD, Bucket>} buckets
+		* @brief The connections of each process in the collected tables
+		*/
+		std::unordered_map<DWORD, Bucket> buckets;
+
+		/**
+		* @var {std::vector<Key>} rows
+		* @brief The collected connections grouped by owning pid, reused from one tick to the next
+		*/
+		std::vector<Key> rows;
+
+		/**
+		* @var {uint32_t} tick
+		* @brief The number of calls to expire, used to find the connections that were not sampled
+		*/
+		uint32_t tick = 0;
+};
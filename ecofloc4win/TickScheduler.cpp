@@ -0,0 +1,190 @@
+/**
+ * @file TickScheduler.cpp
+ * @brief Definition of the ticks driving the component samplers.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "TickScheduler.h"
+#include "TimerWheel.h"
+
+#include <algorithm>
+#include <deque>
+
+double TickScheduler::Tick::getSeconds() const
+{
+	return std::chrono::duration<double>(end - start).count();
+}
+
+TickScheduler::~TickScheduler()
+{
+	stop();
+}
+
+void TickScheduler::addSource(Source source)
+{
+	sources.push_back(std::move(source));
+}
+
+bool TickScheduler::start(PeriodProvider periodProvider, FrameHandler frameHandler)
+{
+	if (clock.joinable() || sources.empty())
+	{
+		return false;
+	}
+
+	period = std::move(periodProvider);
+	onFrame = std::move(frameHandler);
+	stopping = false;
+	tasks.clear();
+	nextTask = 0;
+
+	// The samplers mostly wait on the system, one worker per source up to the number of processors
+	size_t workerCount = std::min<size_t>(sources.size(), std::max(1u, std::thread::hardware_concurrency()));
+	for (size_t i = 0; i < workerCount; i++)
+	{
+		workers.emplace_back(&TickScheduler::work, this);
+	}
+
+	clock = std::thread(&TickScheduler::run, this);
+	return true;
+}
+
+void TickScheduler::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	changed.notify_all();
+
+	if (clock.joinable())
+	{
+		clock.join();
+	}
+
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+	workers.clear();
+}
+
+void TickScheduler::run()
+{
+	// Timers 0 to n - 1 are the sources, timer n the output frames, the wheel counts milliseconds since epoch
+	const size_t output = sources.size();
+	const Clock::time_point epoch = Clock::now();
+	auto toTime = [epoch](uint64_t ms) { return epoch + std::chrono::milliseconds(ms); };
+
+	TimerWheel wheel(0);
+	std::vector<uint64_t> windowStart(output + 1, 0);
+	std::vector<uint64_t> indices(output + 1, 0);
+	std::vector<size_t> expired;
+	std::deque<Tick> unsettled;
+	uint64_t skippedTicks = 0;
+
+	uint64_t outputPeriod = std::max<int64_t>(period().count(), 1);
+	auto cadenceOf = [&](size_t timer) -> uint64_t
+	{
+		if (timer == output || sources[timer].cadence.count() <= 0)
+		{
+			return outputPeriod;
+		}
+		return static_cast<uint64_t>(sources[timer].cadence.count());
+	};
+
+	for (size_t timer = 0; timer <= output; timer++)
+	{
+		wheel.schedule(timer, cadenceOf(timer));
+	}
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		// Every timer is scheduled again once fired, the wheel is never empty
+		uint64_t next = 0;
+		wheel.nextDue(next);
+		if (changed.wait_until(lock, toTime(next), [this] { return stopping; }))
+		{
+			return;
+		}
+
+		expired.clear();
+		wheel.advance(next, expired);
+		outputPeriod = std::max<int64_t>(period().count(), 1);
+
+		// Fan the sources due out to the workers and wait for all of them, the wheel fired them all at their deadline
+		tasks.clear();
+		for (size_t timer : expired)
+		{
+			Tick tick = { indices[timer]++, toTime(windowStart[timer]), toTime(next) };
+			windowStart[timer] = next;
+
+			if (timer == output)
+			{
+				unsettled.push_back(tick);
+			}
+			else
+			{
+				tasks.push_back({ timer, tick });
+			}
+		}
+
+		nextTask = 0;
+		pendingTasks = tasks.size();
+		changed.notify_all();
+		changed.wait(lock, [this] { return pendingTasks == 0; });
+
+		// The next deadline follows the previous one, the deadlines missed while sampling are skipped
+		uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - epoch).count());
+		for (size_t timer : expired)
+		{
+			uint64_t cadence = cadenceOf(timer);
+			uint64_t due = windowStart[timer] + cadence;
+			if (due <= now)
+			{
+				uint64_t missed = (now - due) / cadence + 1;
+				due += missed * cadence;
+				skippedTicks += missed;
+			}
+			wheel.schedule(timer, due);
+		}
+
+		// Every source sampled up to the end of its last window, the frames before the earliest one are complete
+		Clock::time_point settled = toTime(*std::min_element(windowStart.begin(), windowStart.begin() + output));
+		while (!unsettled.empty() && unsettled.front().end <= settled)
+		{
+			Frame frame = { unsettled.front(), std::chrono::system_clock::now(), Clock::now() - unsettled.front().end, skippedTicks };
+			unsettled.pop_front();
+
+			lock.unlock();
+			onFrame(frame);
+			lock.lock();
+		}
+	}
+}
+
+void TickScheduler::work()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		changed.wait(lock, [this] { return stopping || nextTask < tasks.size(); });
+		if (nextTask >= tasks.size())
+		{
+			return;
+		}
+
+		Task task = tasks[nextTask++];
+
+		lock.unlock();
+		sources[task.source].sampler(task.tick);
+		lock.lock();
+
+		if (--pendingTasks == 0)
+		{
+			changed.notify_all();
+		}
+	}
+}
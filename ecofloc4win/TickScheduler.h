@@ -0,0 +1,197 @@
+/**
+ * @file TickScheduler.h
+ * @brief Implementation of the ticks driving the component samplers.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class TickScheduler
+ * @brief Fires every sampler at its own cadence and publishes frames on a common output timeline.
+ *
+ * Each source declares the cadence its data is refreshed at, the output frames follow the user interval.
+ * The deadlines live on a hierarchical timer wheel with a millisecond resolution, which gives the next one
+ * the clock thread waits for. They are computed from the previous deadline rather than from the end of the
+ * work, so they do not drift. The samplers due at the same deadline are fanned out to a small pool of
+ * workers and joined. A frame is published once every source has sampled past its end, so it can be
+ * resampled from complete data. A sampler that overruns its next deadlines skips them, its next window is
+ * then longer.
+ */
+class TickScheduler
+{
+	public:
+
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		* @struct Tick
+		* @brief A window of time, the one a sampler accounts or the one of an output frame
+		*/
+		struct Tick
+		{
+			uint64_t index;
+			Clock::time_point start;
+			Clock::time_point end;
+
+			/**
+			* @brief Gets the length of the window
+			* @function getSeconds
+			* @returns {double} the length of the window in seconds
+			*/
+			double getSeconds() const;
+		};
+
+		/**
+		* @struct Frame
+		* @brief An output window every source has sampled past
+		*/
+		struct Frame
+		{
+			Tick tick;
+			std::chrono::system_clock::time_point timestamp;
+			Clock::duration latency;
+			uint64_t skippedTicks;
+		};
+
+		using Sampler = std::function<void(const Tick&)>;
+		using FrameHandler = std::function<void(const Frame&)>;
+		using PeriodProvider = std::function<std::chrono::milliseconds()>;
+
+		/**
+		* @struct Source
+		* @brief A sampler and the cadence it is called at, a cadence of 0 follows the output period
+		*/
+		struct Source
+		{
+			Sampler sampler;
+			std::chrono::milliseconds cadence;
+		};
+
+		TickScheduler() = default;
+		~TickScheduler();
+
+		TickScheduler(const TickScheduler&) = delete;
+		TickScheduler& operator=(const TickScheduler&) = delete;
+
+		/**
+		* @brief Adds a source, before the scheduler is started
+		* @function addSource
+		* @param {Source} source - The sampler and its cadence
+		*/
+		void addSource(Source source);
+
+		/**
+		* @brief Starts the clock thread and the workers
+		* @function start
+		* @param {PeriodProvider} period - Gives the period of the output frames, read at each frame
+		* @param {FrameHandler} onFrame - Called on the clock thread with each settled frame, in order
+		* @returns {bool} true if the scheduler started, false if it was already running or has no source
+		*/
+		bool start(PeriodProvider period, FrameHandler onFrame);
+
+		/**
+		* @brief Stops the ticks once the current samplers are done and joins the threads
+		* @function stop
+		*/
+		void stop();
+
+	private:
+
+		/**
+		* @struct Task
+		* @brief A source to sample on a window
+		*/
+		struct Task
+		{
+			size_t source;
+			Tick tick;
+		};
+
+		/**
+		* @brief Waits for the deadlines, runs the sources due and publishes the settled frames
+		* @function run
+		*/
+		void run();
+
+		/**
+		* @brief Runs the tasks of the deadlines on a worker thread
+		* @function work
+		*/
+		void work();
+
+		/**
+		* @var {std::vector<Source>} sources
+		* @brief The sources sampled by the scheduler
+		*/
+		std::vector<Source> sources;
+
+		/**
+		* @var {PeriodProvider} period
+		* @brief Gives the period of the output frames
+		*/
+		PeriodProvider period;
+
+		/**
+		* @var {FrameHandler} onFrame
+		* @brief Receives the settled frames
+		*/
+		FrameHandler onFrame;
+
+		/**
+		* @var {std::thread} clock
+		* @brief The thread waiting for the deadlines
+		*/
+		std::thread clock;
+
+		/**
+		* @var {std::vector<std::thread>} workers
+		* @brief The threads running the samplers
+		*/
+		std::vector<std::thread> workers;
+
+		/**
+		* @var {std::mutex} mutex
+		* @brief Protects the dispatch state below
+		*/
+		std::mutex mutex;
+
+		/**
+		* @var {std::condition_variable} changed
+		* @brief Signals new tasks, completed tasks or the stop
+		*/
+		std::condition_variable changed;
+
+		/**
+		* @var {std::vector<Task>} tasks
+		* @brief The tasks of the current deadline
+		*/
+		std::vector<Task> tasks;
+
+		/**
+		* @var {size_t} nextTask
+		* @brief The next task to give to a worker
+		*/
+		size_t nextTask = 0;
+
+		/**
+		* @var {size_t} pendingTasks
+		* @brief The tasks of the current deadline that did not complete yet
+		*/
+		size_t pendingTasks = 0;
+
+		/**
+		* @var {bool} stopping
+		* @brief true once stop was called
+		*/
+		bool stopping = false;
+};
@@ -0,0 +1,159 @@
+/**
+ * @file TimerWheel.cpp
+ * @brief Definition of the hierarchical timer wheel.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#include "TimerWheel.h"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static_assert(TimerWheel::SLOTS == 64, "The occupied slots of a level are one 64-bit word");
+
+/**
+ * @brief Gets the position of the lowest set bit of a word
+ * @function lowestBit
+ * @param {uint64_t} bits - The word, not 0
+ * @returns {size_t} the position of its lowest set bit
+ */
+static size_t lowestBit(uint64_t bits)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, bits);
+	return index;
+#else
+	return static_cast<size_t>(__builtin_ctzll(bits));
+#endif
+}
+
+/**
+ * @brief Rotates a word to the right
+ * @function rotateRight
+ * @param {uint64_t} bits - The word
+ * @param {size_t} count - The number of positions, below 64
+ * @returns {uint64_t} the rotated word
+ */
+static uint64_t rotateRight(uint64_t bits, size_t count)
+{
+	return count == 0 ? bits : (bits >> count) | (bits << (64 - count));
+}
+
+TimerWheel::TimerWheel(uint64_t now) : now(now)
+{
+}
+
+void TimerWheel::schedule(size_t timer, uint64_t due)
+{
+	// The slot of the current tick was already handled
+	due = std::max(due, now + 1);
+
+	// Past the last level the deadline would alias a nearer one
+	due = std::min(due, now + (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1);
+
+	place({ timer, due });
+}
+
+void TimerWheel::place(const Entry& entry)
+{
+	uint64_t delta = entry.due - now;
+
+	size_t level = 0;
+	while (level + 1 < LEVELS && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1))))
+	{
+		level++;
+	}
+
+	size_t slot = static_cast<size_t>(entry.due >> (SLOT_BITS * level)) & (SLOTS - 1);
+	slots[level][slot].push_back(entry);
+	occupied[level] |= uint64_t(1) << slot;
+}
+
+void TimerWheel::advance(uint64_t to, std::vector<size_t>& expired)
+{
+	while (now < to)
+	{
+		// Only the occupied slots of the first level and its turns, where the levels above move down, need a visit
+		uint64_t turn = (now | (SLOTS - 1)) + 1;
+		uint64_t next = std::min(to, turn);
+		size_t position = static_cast<size_t>(now & (SLOTS - 1));
+		uint64_t ahead = position + 1 < SLOTS ? occupied[0] & (~uint64_t(0) << (position + 1)) : 0;
+		if (ahead != 0)
+		{
+			next = std::min(next, (now & ~uint64_t(SLOTS - 1)) + lowestBit(ahead));
+		}
+		now = next;
+
+		// When a level completes a turn, move the next slot of the level above down
+		for (size_t level = 1; level < LEVELS; level++)
+		{
+			if ((now & ((uint64_t(1) << (SLOT_BITS * level)) - 1)) != 0)
+			{
+				break;
+			}
+
+			size_t slot = static_cast<size_t>(now >> (SLOT_BITS * level)) & (SLOTS - 1);
+			if ((occupied[level] & (uint64_t(1) << slot)) == 0)
+			{
+				continue;
+			}
+
+			cascading.swap(slots[level][slot]);
+			occupied[level] &= ~(uint64_t(1) << slot);
+			for (const Entry& entry : cascading)
+			{
+				place(entry);
+			}
+			cascading.clear();
+		}
+
+		// Every timer of the first level slot of the current tick is due now
+		size_t slot = static_cast<size_t>(now & (SLOTS - 1));
+		std::vector<Entry>& current = slots[0][slot];
+		for (const Entry& entry : current)
+		{
+			expired.push_back(entry.timer);
+		}
+		current.clear();
+		occupied[0] &= ~(uint64_t(1) << slot);
+	}
+}
+
+bool TimerWheel::nextDue(uint64_t& due) const
+{
+	bool found = false;
+	for (size_t level = 0; level < LEVELS; level++)
+	{
+		if (occupied[level] == 0)
+		{
+			continue;
+		}
+
+		// The deadlines of a level follow the order of its slots from the one after the current tick, a full
+		// turn ahead at most; a deadline of a lower level may still come before the ones of this level
+		size_t position = static_cast<size_t>(now >> (SLOT_BITS * level)) & (SLOTS - 1);
+		size_t first = (position + 1) & (SLOTS - 1);
+		size_t slot = (first + lowestBit(rotateRight(occupied[level], first))) & (SLOTS - 1);
+
+		for (const Entry& entry : slots[level][slot])
+		{
+			if (!found || entry.due < due)
+			{
+				due = entry.due;
+				found = true;
+			}
+		}
+	}
+
+	return found;
+}
+
+uint64_t TimerWheel::getNow() const
+{
+	return now;
+}
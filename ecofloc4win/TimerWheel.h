@@ -0,0 +1,125 @@
+/**
+ * @file TimerWheel.h
+ * @brief Implementation of the hierarchical timer wheel.
+ * @author Ecofloc's Team
+ * @date 2025-02-03
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class TimerWheel
+ * @brief Hierarchical timer wheel firing timers identified by an index, in ticks of a fixed resolution.
+ *
+ * The first level has one slot per tick, each next level one slot per full turn of the previous one.
+ * A timer is placed on the level matching how far its deadline is and moves down when the wheel turns
+ * over its slot, so scheduling is O(1). Each level keeps a bitmap of its occupied slots: advancing jumps
+ * from one occupied slot or turn of the first level to the next instead of visiting every tick, and the
+ * next deadline is found without looking at the empty slots.
+ */
+class TimerWheel
+{
+	public:
+
+		/**
+		* @var {size_t} SLOT_BITS
+		* @brief The log2 of the number of slots of a level
+		*/
+		static constexpr size_t SLOT_BITS = 6;
+
+		/**
+		* @var {size_t} SLOTS
+		* @brief The number of slots of a level
+		*/
+		static constexpr size_t SLOTS = size_t(1) << SLOT_BITS;
+
+		/**
+		* @var {size_t} LEVELS
+		* @brief The number of levels, the wheel spans SLOTS^LEVELS ticks
+		*/
+		static constexpr size_t LEVELS = 4;
+
+		/**
+		* @brief Builds an empty wheel
+		*
+		* @param {uint64_t} now - The current tick
+		*/
+		explicit TimerWheel(uint64_t now = 0);
+
+		/**
+		* @brief Schedules a timer, a deadline already reached fires at the next tick
+		* @function schedule
+		* @param {size_t} timer - The index of the timer
+		* @param {uint64_t} due - The tick the timer fires at, clamped to the span of the wheel
+		*/
+		void schedule(size_t timer, uint64_t due);
+
+		/**
+		* @brief Moves the wheel to a tick and collects the timers fired on the way
+		* @function advance
+		* @param {uint64_t} to - The new current tick
+		* @param {std::vector<size_t>} expired - A reference where the fired timers are appended in deadline order
+		*/
+		void advance(uint64_t to, std::vector<size_t>& expired);
+
+		/**
+		* @brief Gets the earliest deadline of the scheduled timers
+		* @function nextDue
+		* @param {uint64_t} due - A reference where the tick of the deadline will be stored
+		* @returns {bool} true if a timer is scheduled, false if the wheel is empty
+		*/
+		bool nextDue(uint64_t& due) const;
+
+		/**
+		* @brief Gets the current tick
+		* @function getNow
+		* @returns {uint64_t} the current tick
+		*/
+		uint64_t getNow() const;
+
+	private:
+
+		/**
+		* @struct Entry
+		* @brief A scheduled timer
+		*/
+		struct Entry
+		{
+			size_t timer;
+			uint64_t due;
+		};
+
+		/**
+		* @brief Puts a timer in the slot matching its deadline
+		* @param {Entry} entry - The timer, its deadline is not before the current tick
+		*/
+		void place(const Entry& entry);
+
+		/**
+		* @var {std::vector<Entry>} slots
+		* @brief The timers of each slot of each level
+		*/
+		std::vector<Entry> slots[LEVELS][SLOTS];
+
+		/**
+		* @var {uint64_t[]} occupied
+		* @brief The bit of each slot holding a timer, one word per level
+		*/
+		uint64_t occupied[LEVELS] = {};
+
+		/**
+		* @var {std::vector<Entry>} cascading
+		* @brief The timers of a slot being moved down, kept to reuse its buffer
+		*/
+		std::vector<Entry> cascading;
+
+		/**
+		* @var {uint64_t} now
+		* @brief The current tick
+		*/
+		uint64_t now;
+};
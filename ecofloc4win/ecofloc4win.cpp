@@ -34,10 +34,22 @@
 #include <iostream>
 #include <tcpmib.h>
 #include <atomic>
+#include <numeric>
 
 #include "process.h"         // Custom header for process handling
 #include "GPU.h"             // Custom header for GPU monitoring
 #include "CPU.h"
+#include "PowerSource.h"
+#include "CpuSampler.h"
+#include "InstanceIndex.h"
+#include "DiskIoTracer.h"
+#include "NetworkTracer.h"
+#include "TcpConnectionTracker.h"
+#include "TickScheduler.h"
+#include "Resampler.h"
+#include "AppSet.h"
+#include "EnergyLedger.h"
+#include "PowerHistory.h"
 #include "MonitoringData.h"  // Custom header for monitoring data
 #include "Utils.h"
 
@@ -52,40 +64,46 @@
 using namespace ftxui;
 
 /**
- * @var {std::vector<MonitoringData>} monitoringData
- * @brief The array that content all the energy used by each component for each process
+ * @var {AppSet} appSet
+ * @brief The monitored applications
  */
-std::vector<MonitoringData> monitoringData = {};
+AppSet appSet;
 
 /**
- * @var {std::mutex} dataMutex
- * @brief Protects shared data
+ * @var {EnergyLedger} ledger
+ * @brief The energy and the power of each component for each monitored application
  */
-std::mutex dataMutex;
+EnergyLedger ledger;
 
 /**
- * @var {std::atomic<bool>} newDataCpu
- * @brief Stores CPU newest data
+ * @var {size_t} HISTORY_RETENTION
+ * @brief The number of output frames kept for each application and component, 4 minutes at the default interval
  */
-std::atomic<bool> newDataCpu(false);
+constexpr size_t HISTORY_RETENTION = 480;
 
 /**
- * @var {std::atomic<bool>} newDataGpu
- * @brief Stores GPU newest data
+ * @var {PowerHistory} history
+ * @brief The power of each component for each monitored application over the last output frames
  */
-std::atomic<bool> newDataGpu(false);
+PowerHistory history(EnergyLedger::CAPACITY, HISTORY_RETENTION);
 
 /**
- * @var {std::atomic<bool>} newDataSd
- * @brief Stores SD newest data
+ * @var {size_t} SPARKLINE_WIDTH
+ * @brief The number of frames drawn after the power of each component
  */
-std::atomic<bool> newDataSd(false);
+constexpr size_t SPARKLINE_WIDTH = 16;
 
 /**
- * @var {std::atomic<bool>} newDataNic
- * @brief Stores NIC newest data
+ * @var {size_t} MAX_DETAILED_PIDS
+ * @brief The number of pids detailed after the CPU energy of an application, the others are only counted
  */
-std::atomic<bool> newDataNic(false);
+constexpr size_t MAX_DETAILED_PIDS = 3;
+
+/**
+ * @var {Resampler} resampler
+ * @brief Spreads the energies of the samplers over the output frames
+ */
+Resampler resampler;
 
 /**
  * @var {std::unordered_map<std::string, int>} actions
@@ -160,38 +178,55 @@ void enable(const std::string& lineNumber, const std::string& component);
 void disable(const std::string& lineNumber, const std::string& component);
 
 /**
- * @brief Gets the localized counter path for a given process name and counter name to be used in PDH functions
- * 		  and avoid hardcoding the counter path for each language.
- * @function getLocalizedCounterPath
- * @param {std::wstring} processName - The name of the process
- * @param {std::string} counterName - The name of the counter
- * @returns {std::wstring} the localized counter path for the process
+ * @brief Creates the sampler accounting the GPU energy of the monitored applications
+ * @function makeGpuSampler
+ * @returns {TickScheduler::Source} the sampler and its cadence
  */
-std::wstring getLocalizedCounterPath(const std::wstring& processName, const std::string& counterName);
+TickScheduler::Source makeGpuSampler();
 
 /**
- * @brief Retrieves the name of the Process thank to its ID
- * @function getProcessNameByPID
- * @param {DWORD} processID - The ID of the Process
- * @returns {std::wstring} the name of the Process
+ * @brief Creates the sampler accounting the storage device energy of the monitored applications
+ * @function makeSdSampler
+ * @returns {TickScheduler::Source} the sampler and its cadence
  */
-std::wstring getProcessNameByPID(DWORD processID);
+TickScheduler::Source makeSdSampler();
+
+/**
+ * @brief Creates the sampler accounting the network interface energy of the monitored applications
+ * @function makeNicSampler
+ * @returns {TickScheduler::Source} the sampler and its cadence
+ */
+TickScheduler::Source makeNicSampler();
 
 /**
- * @brief Gets the index of a counter in the registry based on its name.
- * @function getCounterIndex
- * @param {std::string} counterName - The name of the counter
- * @returns {DWORD} the Index of the counter
+ * @brief Creates the sampler accounting the CPU energy of the monitored applications
+ * @function makeCpuSampler
+ * @returns {TickScheduler::Source} the sampler and its cadence, without sampler if no CPU power source is available
  */
-DWORD getCounterIndex(const std::string& counterName);
+TickScheduler::Source makeCpuSampler();
 
 /**
- * @brief Gets the name of the instance for a given process ID.
- * @function getInstanceForPID
- * @param {int} targetPID - The pid
- * @returns {std::wstring} the name of the instance
+ * @brief Updates the power of every monitored application from the energy resampled on an output frame
+ * @function updatePowers
+ * @param {TickScheduler::Frame} frame - The output frame every sampler has sampled past
  */
-std::wstring getInstanceForPID(int targetPID);
+void updatePowers(const TickScheduler::Frame& frame);
+
+/**
+ * @brief Draws the power of the last frames with one block character per frame
+ * @function sparkline
+ * @param {std::vector<PowerHistory::Sample>} samples - The frames, from the oldest
+ * @returns {std::string} the UTF-8 sparkline, scaled on the highest power of the frames
+ */
+std::string sparkline(const std::vector<PowerHistory::Sample>& samples);
+
+/**
+ * @brief Retrieves the name of the Process thank to its ID
+ * @function getProcessNameByPID
+ * @param {DWORD} processID - The ID of the Process
+ * @returns {std::wstring} the name of the Process
+ */
+std::wstring getProcessNameByPID(DWORD processID);
 
 /**
  * @brief Generates all rows of the table to show in the terminal
@@ -201,33 +236,98 @@ std::wstring getInstanceForPID(int targetPID);
 auto createTableRows() -> std::vector<std::vector<std::string>>
 {
 	std::vector<std::vector<std::string>> rows;
-	std::lock_guard<std::mutex> lock(dataMutex);
+	std::shared_ptr<const AppSet::Snapshot> snapshot = appSet.load();
+
+	// The numbers come from the ledger columns, the snapshot only gives the names
+	std::vector<AppId> ids;
+	ids.reserve(snapshot->apps.size());
+	for (const auto& data : snapshot->apps)
+	{
+		ids.push_back(data.getId());
+	}
+
+	std::vector<EnergyLedger::Reading> readings[COMPONENT_COUNT];
+	for (size_t component = 0; component < COMPONENT_COUNT; component++)
+	{
+		ledger.read(static_cast<ComponentType>(component), ids, readings[component]);
+	}
+	const auto& cpu = readings[static_cast<size_t>(ComponentType::CPU)];
+	const auto& gpu = readings[static_cast<size_t>(ComponentType::GPU)];
+	const auto& sd = readings[static_cast<size_t>(ComponentType::SD)];
+	const auto& nic = readings[static_cast<size_t>(ComponentType::NIC)];
+
+	// The recent power of each cell, the buffer keeps its capacity from one cell to the next
+	std::vector<PowerHistory::Sample> samples;
+	samples.reserve(SPARKLINE_WIDTH);
+	auto drawHistory = [&samples](AppId id, ComponentType component)
+	{
+		history.latest(id, component, SPARKLINE_WIDTH, samples);
+		return sparkline(samples);
+	};
 
 	int rowNumber = 1;
 
 	rows.emplace_back(std::vector<std::string>{"Line", "Application Name", "CPU", "GPU", "SD", "NIC"});
-	for (const auto& data : monitoringData)
+	for (size_t i = 0; i < snapshot->apps.size(); i++)
 	{
+		const auto& data = snapshot->apps[i];
+
 		std::ostringstream cpuEnergyStream;
-		cpuEnergyStream << std::fixed << std::setprecision(2) << data.getCPUEnergy();
+		cpuEnergyStream << std::fixed << std::setprecision(2) << cpu[i].joules << " J, " << cpu[i].watts << " W " << drawHistory(data.getId(), ComponentType::CPU);
+
+		// Detail the pids that used the most energy when there is more than one
+		std::vector<double> pidsCPUEnergy = data.getPidsCPUEnergy();
+		if (pidsCPUEnergy.size() > 1)
+		{
+			std::vector<size_t> order(pidsCPUEnergy.size());
+			std::iota(order.begin(), order.end(), 0);
+			size_t shown = std::min(order.size(), MAX_DETAILED_PIDS);
+			std::partial_sort(order.begin(), order.begin() + shown, order.end(), [&pidsCPUEnergy](size_t a, size_t b)
+			{
+				return pidsCPUEnergy[a] > pidsCPUEnergy[b];
+			});
+
+			cpuEnergyStream << " (";
+			for (size_t pid = 0; pid < shown; pid++)
+			{
+				cpuEnergyStream << (pid > 0 ? " | " : "") << data.getPids()[order[pid]] << ": " << pidsCPUEnergy[order[pid]] << " J";
+			}
+			if (order.size() > shown)
+			{
+				cpuEnergyStream << " | +" << order.size() - shown << " more";
+			}
+			cpuEnergyStream << ")";
+		}
 
 		std::ostringstream gpuEnergyStream;
-		gpuEnergyStream << std::fixed << std::setprecision(2) << data.getGPUEnergy();
+		gpuEnergyStream << std::fixed << std::setprecision(2) << gpu[i].joules << " J, " << gpu[i].watts << " W " << drawHistory(data.getId(), ComponentType::GPU);
+
+		// Detail each GPU when there is more than one
+		std::vector<double> gpuDevicesEnergy = data.getGPUDevicesEnergy();
+		if (gpuDevicesEnergy.size() > 1)
+		{
+			gpuEnergyStream << " (";
+			for (size_t device = 0; device < gpuDevicesEnergy.size(); device++)
+			{
+				gpuEnergyStream << (device > 0 ? " | " : "") << "GPU" << device << ": " << gpuDevicesEnergy[device] << " J";
+			}
+			gpuEnergyStream << ")";
+		}
 
 		std::ostringstream sdEnergyStream;
-		sdEnergyStream << std::fixed << std::setprecision(2) << data.getSDEnergy();
+		sdEnergyStream << std::fixed << std::setprecision(2) << sd[i].joules << " J, " << sd[i].watts << " W " << drawHistory(data.getId(), ComponentType::SD);
 
 		std::ostringstream nicEnergyStream;
-		nicEnergyStream << std::fixed << std::setprecision(2) << data.getNICEnergy();
+		nicEnergyStream << std::fixed << std::setprecision(2) << nic[i].joules << " J, " << nic[i].watts << " W " << drawHistory(data.getId(), ComponentType::NIC);
 
 		rows.emplace_back(std::vector<std::string>
 		{
 			std::to_string(rowNumber),
 			data.getName(),
-			" " + cpuEnergyStream.str() + " J ",
-			" " + gpuEnergyStream.str() + " J ",
-			" " + sdEnergyStream.str() + " J ",
-			" " + nicEnergyStream.str() + " J "
+			" " + cpuEnergyStream.str() + " ",
+			" " + gpuEnergyStream.str() + " ",
+			" " + sdEnergyStream.str() + " ",
+			" " + nicEnergyStream.str() + " "
 		});
 		rowNumber++;
 	}
@@ -279,6 +379,9 @@ auto renderTable(int scrollPosition) -> Element
  */
 int main()
 {
+	// Load the hardware sensor backend once, before any sampler needs it
+	CPU::SensorBackend::getInstance();
+
 	std::string input;
 	Component inputBox = Input(&input, "Type here");
 	inputBox |= CatchEvent([&](Event event)
@@ -318,8 +421,9 @@ int main()
 	{
 		int terminalHeight = Utils::getTerminalHeight();
 		int visibleRows = terminalHeight - 8;
+		int appCount = (int)appSet.load()->apps.size();
 
-		if ((int)monitoringData.size() <= visibleRows)
+		if (appCount <= visibleRows)
 		{
 			scrollPosition = 0; // Disable scrolling if all rows fit
 			return false;
@@ -330,7 +434,7 @@ int main()
 		{
 			if (event.mouse().button == Mouse::WheelDown)
 			{
-				scrollPosition = std::min(scrollPosition + 1, (int)monitoringData.size() - visibleRows - 1);
+				scrollPosition = std::min(scrollPosition + 1, appCount - visibleRows - 1);
 				return true;
 			}
 
@@ -343,7 +447,7 @@ int main()
 
 		if (event == Event::ArrowDown)
 		{
-			scrollPosition = std::min(scrollPosition + 1, (int)monitoringData.size() - visibleRows - 1);
+			scrollPosition = std::min(scrollPosition + 1, appCount - visibleRows - 1);
 			return true;
 		}
 
@@ -356,451 +460,544 @@ int main()
 		return false;
 	});
 
-	std::thread gpuThread([&screen]
+	// Every component is sampled at its own cadence, the screen is refreshed at each output frame
+	TickScheduler scheduler;
+	scheduler.addSource(makeGpuSampler());
+	scheduler.addSource(makeSdSampler());
+	scheduler.addSource(makeNicSampler());
+
+	TickScheduler::Source cpuSource = makeCpuSampler();
+	if (cpuSource.sampler)
 	{
-		std::vector<MonitoringData> localMonitoringData;
-		while (true)
-		{
-			// check if new_data is false and localMonitoringData is empty
-			if (newDataGpu.load(std::memory_order_release) == false && localMonitoringData.empty())
-			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(interval));
-				continue;
-			}
+		scheduler.addSource(std::move(cpuSource));
+	}
 
-			if (newDataGpu)
-			{
-				std::unique_lock<std::mutex> lock(dataMutex);
-				localMonitoringData = monitoringData;
-				newDataGpu.store(false, std::memory_order_release);
-			}
+	scheduler.start([]
+	{
+		return std::chrono::milliseconds(interval);
+	},
+	[&screen](const TickScheduler::Frame& frame)
+	{
+		updatePowers(frame);
+		screen.Post(Event::Custom);
+	});
 
-			for (auto& data : localMonitoringData)
-			{
-				if (!data.isGPUEnabled() || data.getPids().empty())
-				{
-					continue;
-				}
+	// Run the application
+	screen.Loop(component);
 
-				int gpuJoules = GPU::getGPUJoules(data.getPids(), interval);
+	scheduler.stop();
+	GPU::shutdownNVML();
+	return 0;
+}
 
-				{
-					std::lock_guard<std::mutex> lock(dataMutex);
-					auto it = std::find_if(monitoringData.begin(), monitoringData.end(),
-					[&](const auto& d)
-					{
-						return d.getPids() == data.getPids();
-					});
+TickScheduler::Source makeGpuSampler()
+{
+	// The state kept from one tick to the next
+	struct State
+	{
+		std::shared_ptr<const AppSet::Snapshot> apps;
+		std::vector<std::unordered_set<int>> localPidSets;
+		EnergyLedger::Batch batch;
+		bool primed = false;
+	};
+
+	std::shared_ptr<State> state = std::make_shared<State>();
+	auto sampler = [state](const TickScheduler::Tick& tick)
+	{
+		auto& [apps, localPidSets, batch, primed] = *state;
 
-					if (it != monitoringData.end())
-					{
-						it->updateGPUEnergy(gpuJoules);
-					}
-				}
+		// Index the pids of each application once per version of the list instead of at every tick
+		std::shared_ptr<const AppSet::Snapshot> current = appSet.load();
+		if (!apps || current->version != apps->version)
+		{
+			apps = std::move(current);
+			localPidSets.clear();
+			for (const auto& data : apps->apps)
+			{
+				localPidSets.emplace_back(data.getPids().begin(), data.getPids().end());
+				ledger.claim(ComponentType::GPU, data.getId());
 			}
-
-			screen.Post(Event::Custom);
-			std::this_thread::sleep_for(std::chrono::milliseconds(interval));
 		}
-	});
 
-	std::thread sdThread([&screen]
-	{
-		PDH_HQUERY query;
-		if (PdhOpenQuery(NULL, 0, &query) != ERROR_SUCCESS)
+		if (apps->apps.empty())
 		{
-			std::cerr << "Failed to open PDH query." << std::endl;
+			primed = false;
 			return;
 		}
 
-		std::map<std::wstring, std::pair<PDH_HCOUNTER, PDH_HCOUNTER>> processCounters;
-
-		std::vector<MonitoringData> localMonitoringData;
-		while (true)
+		// Read every GPU once for all the applications of this tick, the first read only
+		// starts the energy counters since it covers the time spent idle
+		std::vector<GPU::DeviceSample> gpuSamples = GPU::sampleDevices();
+		if (!primed)
 		{
+			primed = true;
+			return;
+		}
 
-			// check if new_data is false and localMonitoringData is empty
-			if (newDataSd.load(std::memory_order_release) == false && localMonitoringData.empty())
+		batch.clear(apps->slots.capacity());
+		for (size_t i = 0; i < apps->apps.size(); i++)
+		{
+			const auto& data = apps->apps[i];
+			if (!data.isGPUEnabled() || localPidSets[i].empty())
 			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(interval));
 				continue;
 			}
 
-			if (newDataSd)
-			{
-				std::unique_lock<std::mutex> lock(dataMutex);
-				localMonitoringData = monitoringData;
-				newDataSd.store(false, std::memory_order_release);
-			}
+			std::vector<double> gpuJoules = GPU::getGPUJoules(gpuSamples, localPidSets[i]);
+			double intervalEnergy = std::accumulate(gpuJoules.begin(), gpuJoules.end(), 0.0);
+			resampler.add(data.getId(), ComponentType::GPU, tick.start, tick.end, intervalEnergy);
+			batch.set(data.getId(), intervalEnergy);
+			data.updateGPUDevicesEnergy(gpuJoules);
+		}
 
+		ledger.accumulate(ComponentType::GPU, batch, tick.end);
+	};
+
+	// The power counter of NVML moves about every 100 ms but the per-process utilization is only
+	// sampled about every 1/6 s, a shorter cadence would fall back to the whole device utilization
+	return { sampler, std::chrono::milliseconds(200) };
+}
 
-			for (auto& data : localMonitoringData)
+TickScheduler::Source makeSdSampler()
+{
+	// The state kept from one tick to the next
+	struct State
+	{
+		DiskIoTracer diskTracer;
+		bool traced = false;
+		uint64_t reportedDrops = 0;
+		InstanceIndex processIndex;
+		int readCounter = -1;
+		int writeCounter = -1;
+		std::shared_ptr<const AppSet::Snapshot> apps;
+		EnergyLedger::Batch batch;
+	};
+
+	std::shared_ptr<State> state = std::make_shared<State>();
+
+	// The kernel trace gives the exact bytes of each process, the PDH rates are only used without it
+	state->traced = state->diskTracer.start();
+
+	// The rates of every process come from one wildcard pair collected with the pid index
+	if (!state->traced)
+	{
+		state->readCounter = state->processIndex.addCounter("IO Read Bytes/sec");
+		state->writeCounter = state->processIndex.addCounter("IO Write Bytes/sec");
+		if (state->readCounter < 0 || state->writeCounter < 0)
+		{
+			std::cerr << "Failed to add the disk PDH counters." << std::endl;
+		}
+	}
+
+	auto sampler = [state](const TickScheduler::Tick& tick)
+	{
+		auto& [diskTracer, traced, reportedDrops, processIndex, readCounter, writeCounter, apps, batch] = *state;
+
+		if (!traced && (readCounter < 0 || writeCounter < 0))
+		{
+			return;
+		}
+
+		std::shared_ptr<const AppSet::Snapshot> current = appSet.load();
+		if (!apps || current->version != apps->version)
+		{
+			std::shared_ptr<const AppSet::Snapshot> previous = std::move(apps);
+			apps = std::move(current);
+
+			// Drop what the traced processes did before their disk was monitored
+			for (const auto& data : apps->apps)
 			{
-				if (!data.isSDEnabled())
+				ledger.claim(ComponentType::SD, data.getId());
+				if (!traced || !data.isSDEnabled())
 				{
 					continue;
 				}
 
-				if (data.getPids().empty())
+				const MonitoringData* before = previous ? previous->find(data.getId()) : nullptr;
+				if (before && before->isSDEnabled())
 				{
 					continue;
 				}
 
-				std::wstring instanceName = getInstanceForPID(data.getPids()[0]);
-				if (instanceName.empty())
+				uint64_t readBytes, writeBytes;
+				for (int pid : data.getPids())
 				{
-					continue;
+					diskTracer.takeBytes(pid, readBytes, writeBytes);
 				}
+			}
+		}
 
-				if (processCounters.find(instanceName) == processCounters.end())
-				{
-					PDH_HCOUNTER counterDiskRead, counterDiskWrite;
-					std::wstring readPath = getLocalizedCounterPath(instanceName, "IO Read Bytes/sec");
-					std::wstring writePath = getLocalizedCounterPath(instanceName, "IO Write Bytes/sec");
+		if (apps->apps.empty())
+		{
+			return;
+		}
 
-					if (PdhAddCounter(query, readPath.c_str(), 0, &counterDiskRead) != ERROR_SUCCESS ||
-						PdhAddCounter(query, writePath.c_str(), 0, &counterDiskWrite) != ERROR_SUCCESS)
-					{
-						std::cerr << "Failed to add PDH counters for: " << data.getName() << std::endl;
-						continue;
-					}
+		// One collection serves every application of the tick
+		if (!traced && !processIndex.refresh())
+		{
+			return;
+		}
 
-					processCounters[instanceName] = { counterDiskRead, counterDiskWrite };
-				}
+		batch.clear(apps->slots.capacity());
+		for (const auto& data : apps->apps)
+		{
+			if (!data.isSDEnabled())
+			{
+				continue;
+			}
 
-				if (PdhCollectQueryData(query) != ERROR_SUCCESS)
+			if (data.getPids().empty())
+			{
+				continue;
+			}
+
+			double readBytes = 0, writeBytes = 0;
+			for (int pid : data.getPids())
+			{
+				if (traced)
 				{
-					std::cerr << "Failed to collect PDH query data." << std::endl;
+					uint64_t pidReadBytes = 0, pidWriteBytes = 0;
+					if (diskTracer.takeBytes(pid, pidReadBytes, pidWriteBytes))
+					{
+						readBytes += static_cast<double>(pidReadBytes);
+						writeBytes += static_cast<double>(pidWriteBytes);
+					}
 					continue;
 				}
 
-				for (auto& [instanceName, counters] : processCounters)
+				// The rates are averaged over the window of the tick
+				double value = 0;
+				if (processIndex.getValue(pid, readCounter, value))
 				{
-					PDH_FMT_COUNTERVALUE diskReadValue, diskWriteValue;
-					long readRate = 0, writeRate = 0;
-
-					if (PdhGetFormattedCounterValue(counters.first, PDH_FMT_LONG, NULL, &diskReadValue) == ERROR_SUCCESS)
-					{
-						readRate = diskReadValue.longValue;
-					}
+					readBytes += value * tick.getSeconds();
+				}
 
-					if (PdhGetFormattedCounterValue(counters.second, PDH_FMT_LONG, NULL, &diskWriteValue) == ERROR_SUCCESS)
-					{
-						writeRate = diskWriteValue.longValue;
-					}
+				if (processIndex.getValue(pid, writeCounter, value))
+				{
+					writeBytes += value * tick.getSeconds();
+				}
+			}
 
-					double readPower = 2.2 * readRate / 5600000000;
-					double writePower = 2.2 * writeRate / 5300000000;
-					double averagePower = readPower + writePower;
+			// Same model as the rates: 2.2 W at 5.6 GB/s read and 5.3 GB/s written
+			double readEnergy = 2.2 * readBytes / 5600000000;
+			double writeEnergy = 2.2 * writeBytes / 5300000000;
 
-					double intervalEnergy = averagePower * interval / 1000;
+			double intervalEnergy = readEnergy + writeEnergy;
+			resampler.add(data.getId(), ComponentType::SD, tick.start, tick.end, intervalEnergy);
+			batch.set(data.getId(), intervalEnergy);
+		}
 
-					{
-						std::lock_guard<std::mutex> lock(dataMutex);
-						auto it = std::find_if(monitoringData.begin(), monitoringData.end(), [&](const auto& d)
-						{
-							return !d.getPids().empty();
-						});
-
-						if (it != monitoringData.end())
-						{
-							it->updateSDEnergy(intervalEnergy);
-						}
-					}
-				}
-			}
+		ledger.accumulate(ComponentType::SD, batch, tick.end);
 
-			screen.Post(Event::Custom);
-			std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+		// The requests lost by a full table are not in the bytes taken above
+		uint64_t drops = traced ? diskTracer.getDroppedEvents() : 0;
+		if (drops > reportedDrops)
+		{
+			std::cerr << "Disk I/O trace dropped " << drops - reportedDrops << " requests, the disk energy is underestimated." << std::endl;
+			reportedDrops = drops;
 		}
+	};
 
-		PdhCloseQuery(query);
-	});
+	// The traced bytes can be drained at any period, the PDH rates are averaged by PDH over about a second
+	return { sampler, std::chrono::milliseconds(state->traced ? 0 : 1000) };
+}
 
-	std::thread nicThread([&screen]
+TickScheduler::Source makeNicSampler()
+{
+	// The state kept from one tick to the next
+	struct State
 	{
-		std::vector<MonitoringData> localMonitoringData;
-		while (true)
+		NetworkTracer networkTracer;
+		bool traced = false;
+		TcpConnectionTracker tcpTracker;
+		int tableFailures = 0;
+		int skippedTicks = 0;
+		TickScheduler::Clock::time_point sampledUntil;
+		std::shared_ptr<const AppSet::Snapshot> apps;
+		EnergyLedger::Batch batch;
+	};
+
+	std::shared_ptr<State> state = std::make_shared<State>();
+
+	// The Kernel-Network events cover TCP and UDP over IPv4 and IPv6, the TCP table is only used without them
+	state->traced = state->networkTracer.start();
+
+	auto sampler = [state](const TickScheduler::Tick& tick)
+	{
+		auto& [networkTracer, traced, tcpTracker, tableFailures, skippedTicks, sampledUntil, apps, batch] = *state;
+
+		std::shared_ptr<const AppSet::Snapshot> current = appSet.load();
+		if (!apps || current->version != apps->version)
 		{
-			// check if new_data is false and localMonitoringData is empty
-			if (newDataNic.load(std::memory_order_release) == false && localMonitoringData.empty())
-			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(interval));
-				continue;
-			}
+			std::shared_ptr<const AppSet::Snapshot> previous = std::move(apps);
+			apps = std::move(current);
 
-			if (newDataNic)
+			// Drop what the traced processes did before their network was monitored
+			for (const auto& data : apps->apps)
 			{
-				std::unique_lock<std::mutex> lock(dataMutex);
-				localMonitoringData = monitoringData;
-				newDataNic.store(false, std::memory_order_release);
-			}
+				ledger.claim(ComponentType::NIC, data.getId());
+				if (!traced || !data.isNICEnabled())
+				{
+					continue;
+				}
 
-			PMIB_TCPTABLE_OWNER_PID tcpTable = nullptr;
-			ULONG ulSize = 0;
+				const MonitoringData* before = previous ? previous->find(data.getId()) : nullptr;
+				if (before && before->isNICEnabled())
+				{
+					continue;
+				}
 
-			// Get the size of the table
-			if (GetExtendedTcpTable(nullptr, &ulSize, TRUE, AF_INET, TCP_TABLE_OWNER_PID_ALL, 0) != ERROR_INSUFFICIENT_BUFFER) {
-				continue;
+				uint64_t sentBytes, receivedBytes;
+				for (int pid : data.getPids())
+				{
+					networkTracer.takeBytes(pid, sentBytes, receivedBytes);
+				}
 			}
+		}
 
-			std::unique_ptr<BYTE[]> buffer(new BYTE[ulSize]);
-			tcpTable = reinterpret_cast<PMIB_TCPTABLE_OWNER_PID>(buffer.get());
-
-			// Get the table data
-			if (GetExtendedTcpTable(tcpTable, &ulSize, TRUE, AF_INET, TCP_TABLE_OWNER_PID_ALL, 0) != NO_ERROR) {
-				continue;
-			}
+		if (apps->apps.empty())
+		{
+			return;
+		}
 
-			for (auto& data : localMonitoringData)
+		if (traced)
+		{
+			batch.clear(apps->slots.capacity());
+			for (const auto& data : apps->apps)
 			{
 				if (!data.isNICEnabled())
 				{
 					continue;
 				}
 
-				for (DWORD i = 0; i < tcpTable->dwNumEntries; i++)
+				double sentBytes = 0, receivedBytes = 0;
+				for (int pid : data.getPids())
 				{
-					// Loop inside the pid list of data
-					for (int& pid : data.getPids())
+					uint64_t pidSentBytes = 0, pidReceivedBytes = 0;
+					if (networkTracer.takeBytes(pid, pidSentBytes, pidReceivedBytes))
 					{
-						if (tcpTable->table[i].dwOwningPid == pid)
-						{
-							MIB_TCPROW_OWNER_PID row = tcpTable->table[i];
-
-							// Enable ESTATS for this connection
-							TCP_ESTATS_DATA_RW_v0 rwData = { 0 };
-							rwData.EnableCollection = TRUE;
-
-							if (SetPerTcpConnectionEStats(reinterpret_cast<PMIB_TCPROW>(&row), TcpConnectionEstatsData,
-								reinterpret_cast<PUCHAR>(&rwData), 0, sizeof(rwData), 0) != NO_ERROR)
-							{
-								continue;
-							}
-
-							if (row.dwState == MIB_TCP_STATE_ESTAB && row.dwRemoteAddr != htonl(INADDR_LOOPBACK))
-							{
-								ULONG rodSize = sizeof(TCP_ESTATS_DATA_ROD_v0);
-								std::vector<BYTE> rodBuffer(rodSize);
-								PTCP_ESTATS_DATA_ROD_v0 dataRod = reinterpret_cast<PTCP_ESTATS_DATA_ROD_v0>(rodBuffer.data());
-
-								// Get the ESTATS data for this connection
-								if (GetPerTcpConnectionEStats(reinterpret_cast<PMIB_TCPROW>(&row), TcpConnectionEstatsData,
-									nullptr, 0, 0, nullptr, 0, 0,
-									reinterpret_cast<PUCHAR>(dataRod), 0, rodSize) == NO_ERROR)
-								{
-
-									// Calculate Bytes In and Bytes Out
-									double bytesIn = static_cast<double>(dataRod->DataBytesIn);
-									double bytesOut = static_cast<double>(dataRod->DataBytesOut);
-
-									double intervalSec = interval / 1000.0; // Interval in seconds (will be chang� in the future)
-
-									long downloadRate = bytesIn / intervalSec;
-									long uploadRate = bytesOut / intervalSec;
-
-									double downloadPower = 1.138 * ((double)downloadRate / 300000); // 1.138 is the power consumption per byte for download (will be chang� in the future using the config)
-									double uploadPower = 1.138 * ((double)uploadRate / 300000); // 1.138 is the power consumption per byte for upload (will be chang� in the future using the config)
-
-									double averagePower = downloadPower + uploadPower;
-
-									{
-										std::lock_guard<std::mutex> lock(dataMutex);
-										// Update the NIC energy for the process
-										auto it = std::find_if(monitoringData.begin(), monitoringData.end(), [&](const MonitoringData& d)
-										{
-											return !d.getPids().empty();
-										});
-
-										if (it != monitoringData.end())
-										{
-											it->updateNICEnergy(averagePower);
-										}
-									}
-								}
-							}
-						}
+						sentBytes += static_cast<double>(pidSentBytes);
+						receivedBytes += static_cast<double>(pidReceivedBytes);
 					}
 				}
+
+				// Same model as the rates: 1.138 W for 300 kB/s in each direction
+				double intervalEnergy = 1.138 * (receivedBytes + sentBytes) / 300000;
+				resampler.add(data.getId(), ComponentType::NIC, tick.start, tick.end, intervalEnergy);
+				batch.set(data.getId(), intervalEnergy);
 			}
 
-			screen.Post(Event::Custom);
-			std::this_thread::sleep_for(std::chrono::milliseconds(interval)); // interval based on user input (will be chang� in the future)
+			ledger.accumulate(ComponentType::NIC, batch, tick.end);
+			return;
 		}
-	});
 
-	std::thread cpuThread([&screen]
-	{
-		std::vector<MonitoringData> localMonitoringData;
-		while (true)
+		// Back off while the table can not be read instead of retrying at every tick, the counters
+		// are cumulative so the next successful tick still gets the bytes of the skipped ones
+		if (skippedTicks > 0)
 		{
-			double totalEnergy = 0.0;
-			double startTotalPower = 0.0;
-			double endTotalPower = 0.0;
-			double avgPowerInterval = 0.0;
+			skippedTicks--;
+			return;
+		}
 
-			// check if new_data is false and localMonitoringData is empty
-			if (newDataCpu.load(std::memory_order_release) == false && localMonitoringData.empty())
-			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(interval));
-				continue;
-			}
+		// Read the IPv4 and IPv6 tables and group their connections by owner, each application then only visits its own
+		if (!tcpTracker.refresh())
+		{
+			// The ticks skipped double after each failed read, up to 15
+			const int maxBackoffShift = 4;
+			tableFailures = std::min(tableFailures + 1, maxBackoffShift);
+			skippedTicks = (1 << tableFailures) - 1;
+			return;
+		}
+		tableFailures = 0;
 
-			if (newDataCpu)
+		// The bytes were transferred since the end of the last window read, not only during this tick
+		TickScheduler::Clock::time_point start = sampledUntil == TickScheduler::Clock::time_point() ? tick.start : std::min(sampledUntil, tick.start);
+		sampledUntil = tick.end;
+
+		batch.clear(apps->slots.capacity());
+		for (const auto& data : apps->apps)
+		{
+			if (!data.isNICEnabled())
 			{
-				std::unique_lock<std::mutex> lock(dataMutex);
-				localMonitoringData = monitoringData;
-				newDataCpu.store(false, std::memory_order_release);
+				continue;
 			}
 
-			// Process each monitoring data entry
-			for (auto& data : localMonitoringData)
+			double bytesIn = 0, bytesOut = 0;
+			for (int pid : data.getPids())
 			{
-				if (!data.isCPUEnabled())
+				// Bytes transferred by the connections of the process since the previous tick
+				uint64_t pidBytesOut = 0, pidBytesIn = 0;
+				if (tcpTracker.takeBytes(pid, pidBytesOut, pidBytesIn))
 				{
-					continue;
+					bytesIn += static_cast<double>(pidBytesIn);
+					bytesOut += static_cast<double>(pidBytesOut);
 				}
+			}
 
-				// Ensure the PID list is not empty
-				if (data.getPids().empty())
-				{
-					std::cerr << "Error: No PIDs available for monitoring data." << std::endl;
-					continue;
-				}
+			// 1.138 W for 300 kB/s in each direction (will be changed in the future using the config)
+			double intervalEnergy = 1.138 * (bytesIn + bytesOut) / 300000;
+			resampler.add(data.getId(), ComponentType::NIC, start, tick.end, intervalEnergy);
 
-				// Get initial CPU and process times
-				uint64_t startCPUTime = CPU::getCPUTime();
-				uint64_t startPidTime = CPU::getPidTime(data.getPids()[0]);
+			// Update the NIC energy for the process
+			batch.set(data.getId(), intervalEnergy);
+		}
 
-				CPU::getCurrentPower(startTotalPower);
+		ledger.accumulate(ComponentType::NIC, batch, tick.end);
 
-				// Monitor for the specified interval
-				std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+		// Forget the connections closed since the previous tick
+		tcpTracker.expire();
+	};
 
-				CPU::getCurrentPower(endTotalPower);
+	// The traced bytes can be drained at any period, reading the TCP tables and the ESTATS of every connection is costly
+	return { sampler, std::chrono::milliseconds(state->traced ? 0 : 1000) };
+}
 
-				avgPowerInterval = (startTotalPower + endTotalPower) / 2;
+TickScheduler::Source makeCpuSampler()
+{
+	std::unique_ptr<PowerSource> powerSource = PowerSource::create();
+	if (!powerSource)
+	{
+		std::cerr << "No CPU power source available." << std::endl;
+		return { nullptr, std::chrono::milliseconds(0) };
+	}
 
-				uint64_t endCPUTime = CPU::getCPUTime();
-				uint64_t endPidTime = CPU::getPidTime(data.getPids()[0]);
+	// Sampling faster than the source refreshes would only measure the same power again
+	std::chrono::milliseconds cadence = powerSource->getCadence();
 
-				// Calculate time differences
-				double pidTimeDiff = static_cast<double>(endPidTime) - static_cast<double>(startPidTime);
-				double cpuTimeDiff = static_cast<double>(endCPUTime) - static_cast<double>(startCPUTime);
+	// The state kept from one tick to the next
+	struct State
+	{
+		explicit State(std::unique_ptr<PowerSource> powerSource) : cpu(std::move(powerSource)) {}
 
-				// Validate time differences
-				if (pidTimeDiff > cpuTimeDiff)
-				{
-					std::cerr << "Error: Process time is greater than CPU time." << std::endl;
-					continue;
-				}
+		CpuSampler cpu;
+		std::shared_ptr<const AppSet::Snapshot> apps;
+		std::vector<const MonitoringData*> cpuApps;
+		EnergyLedger::Batch batch;
+	};
 
-				// Calculate CPU usage and energy consumption
-				double cpuUsage = (pidTimeDiff / cpuTimeDiff);
-				double intervalEnergy = avgPowerInterval * cpuUsage * interval / 1000;
+	std::shared_ptr<State> state = std::make_shared<State>(std::move(powerSource));
 
-				totalEnergy += intervalEnergy;
+	auto sampler = [state](const TickScheduler::Tick& tick)
+	{
+		auto& [cpu, apps, cpuApps, batch] = *state;
 
-				// Update monitoring data safely
+		// Collect every application to measure once per version of the list
+		std::shared_ptr<const AppSet::Snapshot> current = appSet.load();
+		if (!apps || current->version != apps->version)
+		{
+			apps = std::move(current);
+			cpu.clearApps();
+			cpuApps.clear();
+			for (const auto& data : apps->apps)
+			{
+				ledger.claim(ComponentType::CPU, data.getId());
+				if (data.isCPUEnabled() && !data.getPids().empty())
 				{
-					std::lock_guard<std::mutex> lock(dataMutex);
-					auto it = std::find_if(monitoringData.begin(), monitoringData.end(),
-						[&](const auto& d)
-					{
-						return d.getPids() == data.getPids();
-					});
-
-					if (it != monitoringData.end())
-					{
-						it->updateCPUEnergy(totalEnergy);
-					}
+					cpu.addApp(data.getId(), data.getPids());
+					cpuApps.push_back(&data);
 				}
 			}
+		}
 
-			// Notify the screen of an update
-			screen.Post(Event::Custom);
+		if (!cpu.sample())
+		{
+			return;
 		}
-	});
 
+		batch.clear(apps->slots.capacity());
+		for (size_t i = 0; i < cpu.getAppCount(); i++)
+		{
+			batch.set(cpu.getAppId(i), cpu.getAppEnergy(i));
+			cpuApps[i]->updatePidsCPUEnergy(cpu.getPidEnergies(i));
+			resampler.add(cpu.getAppId(i), ComponentType::CPU, tick.start, tick.end, cpu.getAppEnergy(i));
+		}
 
-	// Run the application
-	screen.Loop(component);
+		ledger.accumulate(ComponentType::CPU, batch, tick.end);
+	};
 
-	gpuThread.join();
-	sdThread.join();
-	nicThread.join();
-	cpuThread.join();
-	return 0;
+	return { sampler, cadence };
 }
 
-DWORD getCounterIndex(const std::string& counterName)
+void updatePowers(const TickScheduler::Frame& frame)
 {
-	HKEY hKey;
-	if (RegOpenKeyEx(HKEY_LOCAL_MACHINE, L"SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion\\Perflib\\009", 0, KEY_READ, &hKey) != ERROR_SUCCESS)
+	// Only called from the clock thread, the buffer is reused from one frame to the next
+	static std::vector<Resampler::Output> outputs;
+	resampler.resample(frame.tick.end, outputs);
+
+	double seconds = frame.tick.getSeconds();
+	if (seconds <= 0)
 	{
-		std::cerr << "Failed to open registry key" << std::endl;
-		return -1;
+		return;
 	}
 
-	DWORD dataSize = 0;
-	if (RegQueryValueEx(hKey, L"Counter", NULL, NULL, NULL, &dataSize) != ERROR_SUCCESS)
+	// The applications without energy on a component during the frame did not use it
+	std::shared_ptr<const AppSet::Snapshot> snapshot = appSet.load();
+	static std::vector<double> watts[COMPONENT_COUNT];
+	static std::vector<uint32_t> generations;
+	for (size_t component = 0; component < COMPONENT_COUNT; component++)
 	{
-		std::cerr << "Failed to query registry value size" << std::endl;
-		RegCloseKey(hKey);
-		return -1;
+		watts[component].assign(snapshot->slots.capacity(), 0.0);
 	}
+	generations.assign(snapshot->slots.capacity(), 0);
 
-	// Allocate buffer for the Counter data
-	std::unique_ptr<char[]> buffer(new char[dataSize]);
-	if (RegQueryValueEx(hKey, L"Counter", NULL, NULL, reinterpret_cast<LPBYTE>(buffer.get()), &dataSize) != ERROR_SUCCESS)
+	// The outputs of the removed applications are dropped, their slot may already be reused
+	for (const Resampler::Output& output : outputs)
 	{
-		std::cerr << "Failed to query registry value" << std::endl;
-		RegCloseKey(hKey);
-		return -1;
+		size_t position;
+		if (!snapshot->slots.lookup(output.app, position))
+		{
+			continue;
+		}
+
+		for (size_t component = 0; component < COMPONENT_COUNT; component++)
+		{
+			watts[component][output.app.slot] = output.joules[component] / seconds;
+		}
+		generations[output.app.slot] = output.app.generation;
 	}
 
-	RegCloseKey(hKey);
+	for (size_t component = 0; component < COMPONENT_COUNT; component++)
+	{
+		ledger.setPowers(static_cast<ComponentType>(component), watts[component].data(), generations.data(), watts[component].size());
+	}
 
-	// Parse the buffer
-	std::string temp;
-	std::string currentIndex;
-	bool isIndex = true; // Tracks if the current string is an index or a name
+	// Every application gets a frame, the ones idle on a component included
+	PowerHistory::Clock::time_point end = frame.timestamp - std::chrono::duration_cast<PowerHistory::Clock::duration>(frame.latency);
+	for (const auto& data : snapshot->apps)
+	{
+		AppId id = data.getId();
+		for (size_t component = 0; component < COMPONENT_COUNT; component++)
+		{
+			double power = watts[component][id.slot];
+			history.append(id, static_cast<ComponentType>(component), { end, power, power * seconds });
+		}
+	}
+}
 
-	for (DWORD i = 0; i < dataSize; i += 2)  // Increment by 2 to skip null terminators
+std::string sparkline(const std::vector<PowerHistory::Sample>& samples)
+{
+	// U+2581 to U+2588, from the lowest to the full block
+	static const char* const blocks[] =
 	{
-		if (buffer[i] == '\0') {
-			// Process accumulated string
-			if (!temp.empty())
-			{
-				if (isIndex)
-				{
-					currentIndex = temp;  // Save the index
-				}
-				else
-				{
-					// Debug: Output the parsed index and name
+		"\xE2\x96\x81", "\xE2\x96\x82", "\xE2\x96\x83", "\xE2\x96\x84",
+		"\xE2\x96\x85", "\xE2\x96\x86", "\xE2\x96\x87", "\xE2\x96\x88"
+	};
+	const size_t levels = sizeof(blocks) / sizeof(blocks[0]);
 
-					// Check if the name matches the target counter name
-					if (temp == counterName)
-					{
-						RegCloseKey(hKey);
-						return std::stoul(currentIndex);  // Convert index to integer
-					}
-				}
+	double highest = 0.0;
+	for (const PowerHistory::Sample& sample : samples)
+	{
+		highest = std::max(highest, sample.watts);
+	}
 
-				temp.clear();          // Reset for the next string
-				isIndex = !isIndex;    // Toggle between index and name
-			}
-		}
-		else
-		{
-			temp += buffer[i];  // Append meaningful character (skip '\0')
-		}
+	std::string line;
+	for (const PowerHistory::Sample& sample : samples)
+	{
+		size_t level = highest > 0 ? static_cast<size_t>(sample.watts / highest * (levels - 1) + 0.5) : 0;
+		line += blocks[std::min(level, levels - 1)];
 	}
 
-	// Cleanup and return
-	RegCloseKey(hKey);
-	return -1;  // Counter name not found
+	return line;
 }
 
 std::wstring getProcessNameByPID(DWORD processID)
@@ -823,69 +1020,6 @@ std::wstring getProcessNameByPID(DWORD processID)
 	return L"<unknown>";
 }
 
-std::wstring getInstanceForPID(int targetPID)
-{
-	PDH_HQUERY query = nullptr;
-	PDH_HCOUNTER pidCounter = nullptr;
-
-	DWORD counterIndex = getCounterIndex("ID Process");
-	DWORD processIndex = getCounterIndex("Process");
-
-	std::wstring queryPath = getLocalizedCounterPath(L"*", "ID Process");
-
-
-	// Open a query
-	if (PdhOpenQuery(nullptr, 0, &query) != ERROR_SUCCESS)
-	{
-		std::cerr << "Failed to open PDH query." << std::endl;
-		return L"";
-	}
-
-	// Add the wildcard counter for all processes
-	if (PdhAddCounter(query, queryPath.c_str(), 0, &pidCounter) != ERROR_SUCCESS)
-	{
-		std::cerr << "Failed to add counter for process ID." << std::endl;
-		PdhCloseQuery(query);
-		return L"";
-	}
-
-	// Collect data
-	if (PdhCollectQueryData(query) != ERROR_SUCCESS)
-	{
-		std::cerr << "Failed to collect query data." << std::endl;
-		PdhCloseQuery(query);
-		return L"";
-	}
-
-	// Get counter info to enumerate instances
-	DWORD bufferSize = 0;
-	DWORD itemCount = 0;
-	PdhGetRawCounterArray(pidCounter, &bufferSize, &itemCount, nullptr);
-
-	std::vector<BYTE> buffer(bufferSize);
-	PDH_RAW_COUNTER_ITEM* items = reinterpret_cast<PDH_RAW_COUNTER_ITEM*>(buffer.data());
-	if (PdhGetRawCounterArray(pidCounter, &bufferSize, &itemCount, items) != ERROR_SUCCESS)
-	{
-		std::cerr << "Failed to get counter array." << std::endl;
-		PdhCloseQuery(query);
-		return L"";
-	}
-
-	// Match the target PID with the instance name
-	std::wstring matchedInstance;
-	for (DWORD i = 0; i < itemCount; ++i)
-	{
-		if (static_cast<int>(items[i].RawValue.FirstValue) == targetPID)
-		{
-			matchedInstance = items[i].szName;
-			break;
-		}
-	}
-
-	PdhCloseQuery(query);
-	return matchedInstance;
-}
-
 void readCommand(std::string commandHandle)
 {
 	std::istringstream tokenStream(commandHandle);
@@ -1010,31 +1144,6 @@ void readCommand(std::string commandHandle)
 	}
 }
 
-std::wstring getLocalizedCounterPath(const std::wstring& processName, const std::string& counterName)
-{
-	wchar_t localizedName[PDH_MAX_COUNTER_PATH];
-	wchar_t localizedProcessName[PDH_MAX_COUNTER_PATH];
-	DWORD size = PDH_MAX_COUNTER_PATH;
-	DWORD counterIndex = getCounterIndex(counterName);
-	DWORD processIndex = getCounterIndex("Process");
-
-	if (PdhLookupPerfNameByIndex(NULL, counterIndex, localizedName, &size) != ERROR_SUCCESS)
-	{
-		std::cerr << "Failed to get localized counter path" << std::endl;
-		return L"";
-	}
-
-	if (PdhLookupPerfNameByIndex(NULL, processIndex, localizedProcessName, &size) != ERROR_SUCCESS)
-	{
-		std::cerr << "Failed to get localized counter path" << std::endl;
-		return L"";
-	}
-
-	std::wstring localizedProcessNameW(localizedProcessName);
-	std::wstring localizedNameW(localizedName);
-	return L"\\" + localizedProcessNameW + L"(" + processName + L")\\" + localizedNameW;
-}
-
 void addProcPid(const std::string& pid, const std::string& component)
 {
 	try
@@ -1049,48 +1158,34 @@ void addProcPid(const std::string& pid, const std::string& component)
 			return;
 		}
 
+		appSet.update([&](AppSet::Snapshot& snapshot)
 		{
-			std::unique_lock<std::mutex> lock(dataMutex);
-
 			// Check for duplicate before adding
-			auto it = std::find_if(monitoringData.begin(), monitoringData.end(),
+			auto it = std::find_if(snapshot.apps.begin(), snapshot.apps.end(),
 				[processId](const MonitoringData& data)
 			{
 				return std::find(data.getPids().begin(), data.getPids().end(), processId) != data.getPids().end();
 			});
 
-			if (it == monitoringData.end())
+			if (it != snapshot.apps.end())
 			{
-				MonitoringData data(Utils::wstringToString(processName), { processId });
-				data.enableComponent(component);
-				monitoringData.push_back(data);
-				auto it2 = Utils::componentMap.find(component);
-				if (it2 != Utils::componentMap.end())
-				{
-					it2->second;
-				}
-				
-				switch (it2->second)
-				{
-				case Utils::CPU:
-					newDataCpu.store(true, std::memory_order_release);
-					break;
-				case Utils::GPU:
-					newDataGpu.store(true, std::memory_order_release);
-					break;
-				case Utils::SD:
-					newDataSd.store(true, std::memory_order_release);
-					break;
-				case Utils::NIC:
-					newDataNic.store(true, std::memory_order_release);
-					break;
-				}
+				std::cerr << "Warning: Process with PID " << pid << " is already being monitored." << std::endl;
+				return false;
 			}
-			else
+
+			MonitoringData data(Utils::wstringToString(processName), { processId });
+			data.enableComponent(component);
+			data.setId(snapshot.slots.acquire(snapshot.apps.size()));
+			if (data.getId().slot >= EnergyLedger::CAPACITY)
 			{
-				std::cerr << "Warning: Process with PID " << pid << " is already being monitored." << std::endl;
+				snapshot.slots.release(data.getId());
+				std::cerr << "Error: Too many applications monitored." << std::endl;
+				return false;
 			}
-		}
+
+			snapshot.apps.push_back(data);
+			return true;
+		});
 	}
 	catch (const std::exception& ex)
 	{
@@ -1141,36 +1236,24 @@ void addProcName(const std::string& name, const std::string& component)
 
 	CloseHandle(hSnapshot);
 
-	// Add valid processes to monitoringData
+	// Add valid processes to the monitored applications
 	if (!pids.empty())
 	{
+		appSet.update([&](AppSet::Snapshot& snapshot)
 		{
-			std::unique_lock<std::mutex> lock(dataMutex);
 			MonitoringData data(name, pids);
 			data.enableComponent(component);
-			monitoringData.push_back(data);
-			auto it2 = Utils::componentMap.find(component);
-			if (it2 != Utils::componentMap.end())
+			data.setId(snapshot.slots.acquire(snapshot.apps.size()));
+			if (data.getId().slot >= EnergyLedger::CAPACITY)
 			{
-				it2->second;
+				snapshot.slots.release(data.getId());
+				std::cerr << "Error: Too many applications monitored." << std::endl;
+				return false;
 			}
 
-			switch (it2->second)
-			{
-			case Utils::CPU:
-				newDataCpu.store(true, std::memory_order_release);
-				break;
-			case Utils::GPU:
-				newDataGpu.store(true, std::memory_order_release);
-				break;
-			case Utils::SD:
-				newDataSd.store(true, std::memory_order_release);
-				break;
-			case Utils::NIC:
-				newDataNic.store(true, std::memory_order_release);
-				break;
-			}
-		}
+			snapshot.apps.push_back(data);
+			return true;
+		});
 	}
 	else
 	{
@@ -1189,69 +1272,65 @@ void removeProcByLineNumber(const std::string& lineNumber) noexcept
 			return;
 		}
 
-		std::unique_lock<std::mutex> lock(dataMutex);
-		if (line >= monitoringData.size())
+		appSet.update([&](AppSet::Snapshot& snapshot)
 		{
-			std::cerr << "Error: Line number is out of range." << std::endl;
-			return;
-		}
+			if (line >= snapshot.apps.size())
+			{
+				std::cerr << "Error: Line number is out of range." << std::endl;
+				return false;
+			}
 
-		// Store PIDs to remove before modifying containers
-		const auto& data = monitoringData[line];
-		std::unordered_set<unsigned int> pidsToRemove;
-		pidsToRemove.reserve(data.getPids().size());  // Pre-allocate space
+			// Store PIDs to remove before modifying containers
+			const auto& data = snapshot.apps[line];
+			std::unordered_set<unsigned int> pidsToRemove;
+			pidsToRemove.reserve(data.getPids().size());  // Pre-allocate space
 
-		for (const auto& pid : data.getPids())
-		{
-			pidsToRemove.insert(pid);
-		}
+			for (const auto& pid : data.getPids())
+			{
+				pidsToRemove.insert(pid);
+			}
 
-		// Track components that will be affected for more detailed logging
-		std::vector<std::string> affectedComponents;
+			// Track components that will be affected for more detailed logging
+			std::vector<std::string> affectedComponents;
 
-		// More efficient removal from comp
-		for (auto& [key, value] : comp)
-		{
-			auto& processes = value.first;
-			auto originalSize = processes.size();
+			// More efficient removal from comp
+			for (auto& [key, value] : comp)
+			{
+				auto& processes = value.first;
+				auto originalSize = processes.size();
 
-			// Use erase-remove idiom with an unordered_set for O(1) lookup
-			processes.erase(
-				std::remove_if(processes.begin(), processes.end(),
-					[&pidsToRemove](const process& p)
-				{
-					return pidsToRemove.count(std::stoi(p.getPid())) > 0;
-				}),
-				processes.end()
-			);
+				// Use erase-remove idiom with an unordered_set for O(1) lookup
+				processes.erase(
+					std::remove_if(processes.begin(), processes.end(),
+						[&pidsToRemove](const process& p)
+					{
+						return pidsToRemove.count(std::stoi(p.getPid())) > 0;
+					}),
+					processes.end()
+				);
 
-			// If processes were removed from this component, log it
-			if (processes.size() < originalSize)
-			{
-				affectedComponents.push_back(key);
+				// If processes were removed from this component, log it
+				if (processes.size() < originalSize)
+				{
+					affectedComponents.push_back(key);
+				}
 			}
-		}
-
-		// Remove from monitoringData
-		monitoringData.erase(monitoringData.begin() + line);
 
-		// Optional: Reduce memory footprint
-		monitoringData.shrink_to_fit();
+			// Remove from the list, the samplers still holding the previous snapshot finish their tick with it
+			snapshot.slots.release(data.getId());
+			snapshot.apps.erase(snapshot.apps.begin() + line);
 
-		// Atomic updates with memory ordering
-		newDataCpu.store(true, std::memory_order_release);
-		newDataGpu.store(true, std::memory_order_release);
-		newDataSd.store(true, std::memory_order_release);
-		newDataNic.store(true, std::memory_order_release);
+			// Enhanced logging
+			//std::cout << "Process has been removed from line " << line
+			//	<< ". Affected components: ";
+			for (const auto& component : affectedComponents)
+			{
+				//std::cout << component << " ";
+			}
+			//std::cout << std::endl;
 
-		// Enhanced logging
-		//std::cout << "Process has been removed from line " << line
-		//	<< ". Affected components: ";
-		for (const auto& component : affectedComponents)
-		{
-			//std::cout << component << " ";
-		}
-		//std::cout << std::endl;
+			return true;
+		});
 	}
 	catch (const std::invalid_argument& e)
 	{
@@ -1278,37 +1357,18 @@ void enable(const std::string& lineNumber, const std::string& component)
 			return;
 		}
 
-		std::unique_lock<std::mutex> lock(dataMutex);
-		if (line >= monitoringData.size())
+		// The copy shares the energies of the application, only its components change
+		appSet.update([&](AppSet::Snapshot& snapshot)
 		{
-			std::cerr << "Error: Line number is out of range." << std::endl;
-			return;
-		}
-
-		auto& data = monitoringData[line];
-		data.enableComponent(component);
-
-		auto it = Utils::componentMap.find(component);
-		if (it != Utils::componentMap.end())
-		{
-			it->second;
-		}
+			if (line >= snapshot.apps.size())
+			{
+				std::cerr << "Error: Line number is out of range." << std::endl;
+				return false;
+			}
 
-		switch (it->second)
-		{
-		case Utils::CPU:
-			newDataCpu.store(true, std::memory_order_release);
-			break;
-		case Utils::GPU:
-			newDataGpu.store(true, std::memory_order_release);
-			break;
-		case Utils::SD:
-			newDataSd.store(true, std::memory_order_release);
-			break;
-		case Utils::NIC:
-			newDataNic.store(true, std::memory_order_release);
-			break;
-		}
+			snapshot.apps[line].enableComponent(component);
+			return true;
+		});
 
 		//std::cout << "Component " << component << " has been enabled for process " << data.getName() << " at line " << line << std::endl;
 
@@ -1338,37 +1398,18 @@ void disable(const std::string& lineNumber, const std::string& component)
 			return;
 		}
 
-		std::unique_lock<std::mutex> lock(dataMutex);
-		if (line >= monitoringData.size())
+		// The copy shares the energies of the application, only its components change
+		appSet.update([&](AppSet::Snapshot& snapshot)
 		{
-			std::cerr << "Error: Line number is out of range." << std::endl;
-			return;
-		}
-
-		auto& data = monitoringData[line];
-		data.disableComponent(component);
-
-		auto it = Utils::componentMap.find(component);
-		if (it != Utils::componentMap.end())
-		{
-			it->second;
-		}
+			if (line >= snapshot.apps.size())
+			{
+				std::cerr << "Error: Line number is out of range." << std::endl;
+				return false;
+			}
 
-		switch (it->second)
-		{
-		case Utils::CPU:
-			newDataCpu.store(true, std::memory_order_release);
-			break;
-		case Utils::GPU:
-			newDataGpu.store(true, std::memory_order_release);
-			break;
-		case Utils::SD:
-			newDataSd.store(true, std::memory_order_release);
-			break;
-		case Utils::NIC:
-			newDataNic.store(true, std::memory_order_release);
-			break;
-		}
+			snapshot.apps[line].disableComponent(component);
+			return true;
+		});
 
 		//std::cout << "Component " << component << " has been enabled for process " << data.getName() << " at line " << line << std::endl;
 